@@ -0,0 +1,72 @@
+#include "ActorMetadataCache.h"
+#include "DirectionalMovementHandler.h"
+
+ActorMetadataCache* ActorMetadataCache::GetSingleton()
+{
+	static ActorMetadataCache singleton;
+	return std::addressof(singleton);
+}
+
+ActorMetadataCache::Metadata ActorMetadataCache::Get(RE::Actor* a_actor)
+{
+	if (!a_actor) {
+		return Metadata{};
+	}
+
+	Locker locker(_lock);
+
+	auto [it, bInserted] = _entries.try_emplace(a_actor->GetHandle().native_handle());
+	auto& entry = it->second;
+	if (bInserted || _frame - entry.builtFrame > _maxEntryAge) {
+		entry.metadata = Build(a_actor);
+		entry.builtFrame = _frame;
+	}
+	entry.lastUsedFrame = _frame;
+
+	return entry.metadata;
+}
+
+void ActorMetadataCache::Update(std::uint32_t a_frame)
+{
+	Locker locker(_lock);
+
+	_frame = a_frame;
+	std::erase_if(_entries, [&](const auto& a_entry) { return _frame - a_entry.second.lastUsedFrame > _maxUnusedAge; });
+}
+
+void ActorMetadataCache::Invalidate(RE::ActorHandle a_actorHandle)
+{
+	Locker locker(_lock);
+
+	_entries.erase(a_actorHandle.native_handle());
+}
+
+void ActorMetadataCache::Invalidate(RE::TESObjectREFR* a_refr)
+{
+	if (auto actor = a_refr ? a_refr->As<RE::Actor>() : nullptr) {
+		Invalidate(actor->GetHandle());
+	}
+}
+
+void ActorMetadataCache::Clear()
+{
+	Locker locker(_lock);
+
+	_entries.clear();
+}
+
+ActorMetadataCache::Metadata ActorMetadataCache::Build(RE::Actor* a_actor)
+{
+	Metadata metadata;
+
+	metadata.race = a_actor->GetRace();
+	metadata.bodyPartData = metadata.race ? metadata.race->bodyPartData : nullptr;
+	metadata.targetLockDistanceMultiplier = DirectionalMovementHandler::GetSingleton()->GetTargetLockDistanceRaceSizeMultiplier(metadata.race);
+	metadata.bEssential = a_actor->IsEssential();
+
+	if (auto playerCharacter = RE::PlayerCharacter::GetSingleton()) {
+		metadata.bHostileToPlayer = a_actor->IsHostileToActor(playerCharacter);
+	}
+
+	return metadata;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// Per-actor data that rarely changes, cached on first sight. Entries are dropped by the game events that can change them
+// (death, bleedout, combat state, race switch, 3D load) and refreshed after a while regardless, for changes no event reports.
+class ActorMetadataCache
+{
+public:
+	struct Metadata
+	{
+		RE::TESRace* race = nullptr;
+		RE::BGSBodyPartData* bodyPartData = nullptr;
+		float targetLockDistanceMultiplier = 1.f;
+		bool bHostileToPlayer = false;
+		bool bEssential = false;
+	};
+
+	static ActorMetadataCache* GetSingleton();
+
+	Metadata Get(RE::Actor* a_actor);
+
+	void Update(std::uint32_t a_frame);
+	void Invalidate(RE::ActorHandle a_actorHandle);
+	void Invalidate(RE::TESObjectREFR* a_refr);
+	void Clear();
+
+private:
+	using Lock = std::mutex;
+	using Locker = std::lock_guard<Lock>;
+
+	struct Entry
+	{
+		Metadata metadata;
+		std::uint32_t builtFrame = 0;
+		std::uint32_t lastUsedFrame = 0;
+	};
+
+	static constexpr std::uint32_t _maxEntryAge = 300;  // frames before an entry is rebuilt
+	static constexpr std::uint32_t _maxUnusedAge = 600;  // frames before an unused entry is dropped
+
+	ActorMetadataCache() = default;
+	ActorMetadataCache(const ActorMetadataCache&) = delete;
+	ActorMetadataCache(ActorMetadataCache&&) = delete;
+	~ActorMetadataCache() = default;
+
+	ActorMetadataCache& operator=(const ActorMetadataCache&) = delete;
+	ActorMetadataCache& operator=(ActorMetadataCache&&) = delete;
+
+	static Metadata Build(RE::Actor* a_actor);
+
+	mutable Lock _lock;
+	std::unordered_map<std::uint32_t, Entry> _entries;  // keyed by native actor handle
+	std::uint32_t _frame = 0;
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+// The animation event tags that move the attack state, in a perfect hash table built at compile time. A lookup costs the same whatever the
+// tag: a filter on the length and the first character turns down most events, the rest are hashed on their length and three characters and
+// compared with the one tag in their slot.
+namespace AttackEvents
+{
+	enum class Transition : std::uint8_t
+	{
+		kUnknown,
+		kStart,
+		kMid,
+		kEnd,
+		kStop
+	};
+
+	namespace detail
+	{
+		struct Entry
+		{
+			std::string_view tag;
+			Transition transition = Transition::kUnknown;
+		};
+
+		inline constexpr std::array entries{
+			// Start phase
+			Entry{ "CastOKStart"sv, Transition::kStart },
+			Entry{ "preHitFrame"sv, Transition::kStart },
+			Entry{ "MCO_AttackInitiate"sv, Transition::kStart },
+			Entry{ "MCO_PowerAttackInitiate"sv, Transition::kStart },
+			Entry{ "MCO_InputBuffer"sv, Transition::kStart },
+			Entry{ "TDM_AttackStart"sv, Transition::kStart },
+			Entry{ "Collision_AttackStart"sv, Transition::kStart },
+			Entry{ "Collision_Start"sv, Transition::kStart },
+
+			Entry{ "weaponSwing"sv, Transition::kMid },
+			Entry{ "weaponLeftSwing"sv, Transition::kMid },
+			Entry{ "SoundPlay.WPNSwingUnarmed"sv, Transition::kMid },
+			Entry{ "TDM_AttackMid"sv, Transition::kMid },
+			Entry{ "Collision_Add"sv, Transition::kMid },
+
+			Entry{ "HitFrame"sv, Transition::kEnd },
+			Entry{ "attackWinStart"sv, Transition::kEnd },
+			Entry{ "SkySA_AttackWinStart"sv, Transition::kEnd },
+			Entry{ "MCO_WinOpen"sv, Transition::kEnd },
+			Entry{ "MCO_PowerWinOpen"sv, Transition::kEnd },
+			Entry{ "MCO_TransitionOpen"sv, Transition::kEnd },
+			Entry{ "MCO_Recovery"sv, Transition::kEnd },
+			Entry{ "TDM_AttackEnd"sv, Transition::kEnd },
+			Entry{ "Collision_AttackEnd"sv, Transition::kEnd },
+
+			// Back to none
+			Entry{ "attackStop"sv, Transition::kStop },
+			Entry{ "TDM_AttackStop"sv, Transition::kStop },
+			Entry{ "SkySA_AttackWinEnd"sv, Transition::kStop },
+			Entry{ "MCO_WinClose"sv, Transition::kStop },
+			Entry{ "MCO_PowerWinClose"sv, Transition::kStop },
+			Entry{ "MCO_TransitionClose"sv, Transition::kStop }
+		};
+
+		inline constexpr std::uint32_t slotCount = 64;  // power of two, at least twice the entries so a seed is found quickly
+		static_assert(entries.size() * 2 <= slotCount);
+
+		// FNV-1a over the length and the first and last two characters, enough to tell every tag apart. Tags are at least two characters.
+		[[nodiscard]] constexpr std::uint32_t Hash(std::string_view a_tag, std::uint32_t a_seed)
+		{
+			constexpr std::uint32_t prime = 16777619u;
+
+			std::uint32_t hash = 2166136261u ^ a_seed;
+			hash = (hash ^ static_cast<std::uint32_t>(a_tag.size())) * prime;
+			hash = (hash ^ static_cast<std::uint8_t>(a_tag.front())) * prime;
+			hash = (hash ^ static_cast<std::uint8_t>(a_tag[a_tag.size() - 2])) * prime;
+			hash = (hash ^ static_cast<std::uint8_t>(a_tag.back())) * prime;
+			return hash ^ (hash >> 16);
+		}
+
+		[[nodiscard]] constexpr std::uint32_t FindSeed()
+		{
+			for (std::uint32_t seed = 0; seed < 0x10000; ++seed) {
+				std::array<bool, slotCount> bUsed{};
+				bool bPerfect = true;
+				for (const auto& entry : entries) {
+					auto& bSlotUsed = bUsed[Hash(entry.tag, seed) & (slotCount - 1)];
+					if (bSlotUsed) {
+						bPerfect = false;
+						break;
+					}
+					bSlotUsed = true;
+				}
+
+				if (bPerfect) {
+					return seed;
+				}
+			}
+
+			return UINT32_MAX;
+		}
+
+		inline constexpr std::uint32_t seed = FindSeed();
+		static_assert(seed != UINT32_MAX, "no perfect hash for the attack event tags, hash more characters");
+
+		[[nodiscard]] constexpr std::array<Entry, slotCount> BuildSlots()
+		{
+			std::array<Entry, slotCount> slots{};
+			for (const auto& entry : entries) {
+				slots[Hash(entry.tag, seed) & (slotCount - 1)] = entry;
+			}
+
+			return slots;
+		}
+
+		[[nodiscard]] constexpr std::uint64_t BuildLengthMask()
+		{
+			std::uint64_t mask = 0;
+			for (const auto& entry : entries) {
+				mask |= 1ull << entry.tag.size();
+			}
+
+			return mask;
+		}
+
+		// one bit per ASCII character
+		[[nodiscard]] constexpr std::array<std::uint64_t, 2> BuildFirstCharacterMask()
+		{
+			std::array<std::uint64_t, 2> mask{};
+			for (const auto& entry : entries) {
+				const auto character = static_cast<std::uint8_t>(entry.tag.front());
+				mask[character >> 6] |= 1ull << (character & 63);
+			}
+
+			return mask;
+		}
+
+		[[nodiscard]] constexpr bool AreTagsValid()
+		{
+			for (const auto& entry : entries) {
+				if (entry.tag.size() < 2 || entry.tag.size() >= 64 || static_cast<std::uint8_t>(entry.tag.front()) >= 128) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static_assert(AreTagsValid(), "tags must be 2 to 63 characters long and start with an ASCII character");
+
+		inline constexpr auto slots = BuildSlots();
+		inline constexpr std::uint64_t lengthMask = BuildLengthMask();
+		inline constexpr auto firstCharacterMask = BuildFirstCharacterMask();
+	}
+
+	[[nodiscard]] constexpr Transition Lookup(std::string_view a_tag)
+	{
+		using namespace detail;
+
+		const auto size = a_tag.size();
+		if (size >= 64 || !(lengthMask & (1ull << size))) {
+			return Transition::kUnknown;
+		}
+
+		const auto character = static_cast<std::uint8_t>(a_tag.front());
+		if (character >= 128 || !(firstCharacterMask[character >> 6] & (1ull << (character & 63)))) {
+			return Transition::kUnknown;
+		}
+
+		const auto& slot = slots[Hash(a_tag, seed) & (slotCount - 1)];
+		return slot.tag == a_tag ? slot.transition : Transition::kUnknown;
+	}
+
+	namespace detail
+	{
+		[[nodiscard]] constexpr bool AreEntriesFound()
+		{
+			for (const auto& entry : entries) {
+				if (Lookup(entry.tag) != entry.transition) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static_assert(AreEntriesFound());
+		static_assert(Lookup(""sv) == Transition::kUnknown && Lookup("TDM_AttackMie"sv) == Transition::kUnknown);
+	}
+}
@@ -0,0 +1,51 @@
+#include "BoneCache.h"
+#include "Offsets.h"
+
+BoneCache* BoneCache::GetSingleton()
+{
+	static BoneCache singleton;
+	return std::addressof(singleton);
+}
+
+RE::NiAVObject* BoneCache::LookupBoneNode(RE::NiAVObject* a_root, const RE::BSFixedString& a_name)
+{
+	if (!a_root || a_name.empty()) {
+		return nullptr;
+	}
+
+	Locker locker(_lock);
+
+	auto [skeletonIt, bNewSkeleton] = _skeletons.try_emplace(a_root);
+	auto& skeleton = skeletonIt->second;
+	if (bNewSkeleton) {
+		skeleton.root.reset(a_root);
+		auto userData = a_root->GetUserData();
+		skeleton.formID = userData ? userData->GetFormID() : 0;
+	}
+
+	return skeleton.bones.Find(a_name.data(), _frame, [&](const char*) { return NiAVObject_LookupBoneNodeByName(a_root, a_name, true); });
+}
+
+void BoneCache::Update(std::uint32_t a_frame)
+{
+	Locker locker(_lock);
+
+	_frame = a_frame;
+
+	// our own reference is the only one left, the 3D has been released by the game
+	std::erase_if(_skeletons, [](const auto& a_entry) { return a_entry.second.root->GetRefCount() <= 1; });
+}
+
+void BoneCache::Invalidate(RE::FormID a_formID)
+{
+	Locker locker(_lock);
+
+	std::erase_if(_skeletons, [&](const auto& a_entry) { return a_entry.second.formID == a_formID; });
+}
+
+void BoneCache::Clear()
+{
+	Locker locker(_lock);
+
+	_skeletons.clear();
+}
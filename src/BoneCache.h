@@ -0,0 +1,40 @@
+#pragma once
+#include "SkeletonBones.h"
+
+// Memoizes bone lookups by name per loaded 3D root, so repeated target point queries don't walk the scene graph every time.
+// Entries hold a reference to their root so its address can't be reused while cached, and are dropped once nothing else references
+// the root anymore or the reference's 3D gets loaded/unloaded. Missing bones are looked up again after a while.
+class BoneCache
+{
+public:
+	static BoneCache* GetSingleton();
+
+	RE::NiAVObject* LookupBoneNode(RE::NiAVObject* a_root, const RE::BSFixedString& a_name);
+
+	void Update(std::uint32_t a_frame);
+	void Invalidate(RE::FormID a_formID);
+	void Clear();
+
+private:
+	using Lock = std::mutex;
+	using Locker = std::lock_guard<Lock>;
+
+	struct Skeleton
+	{
+		RE::NiPointer<RE::NiAVObject> root;
+		RE::FormID formID = 0;
+		SkeletonBones bones;
+	};
+
+	BoneCache() = default;
+	BoneCache(const BoneCache&) = delete;
+	BoneCache(BoneCache&&) = delete;
+	~BoneCache() = default;
+
+	BoneCache& operator=(const BoneCache&) = delete;
+	BoneCache& operator=(BoneCache&&) = delete;
+
+	mutable Lock _lock;
+	std::unordered_map<RE::NiAVObject*, Skeleton> _skeletons;
+	std::uint32_t _frame = 0;
+};
@@ -1,8 +1,14 @@
 #include "DirectionalMovementHandler.h"
+#include "ActorMetadataCache.h"
+#include "AttackEvents.h"
+#include "BoneCache.h"
 #include "Settings.h"
 #include "Events.h"
+#include "GraphVariableCache.h"
 #include "Offsets.h"
+#include "Profiler.h"
 #include "Utils.h"
+#include "VectorMath.h"
 
 #include <Psapi.h>
 #include <DbgHelp.h>
@@ -10,6 +16,27 @@
 
 constexpr auto werewolfFormID = 0xCDD84;
 constexpr auto vampireLordFormID = 0x200283A;
+constexpr float targetPointQuerySlack = 512.f;  // candidates are indexed by root position, their target points can be offset from it
+
+static ScreenNeighborGraph::Direction ToScreenDirection(DirectionalMovementHandler::Direction a_direction)
+{
+	using Direction = DirectionalMovementHandler::Direction;
+
+	switch (a_direction) {
+	case Direction::kLeft:
+		return ScreenNeighborGraph::Direction::kLeft;
+	case Direction::kRight:
+		return ScreenNeighborGraph::Direction::kRight;
+	case Direction::kForward:
+	case Direction::kUp:
+		return ScreenNeighborGraph::Direction::kUp;
+	case Direction::kBack:
+	case Direction::kDown:
+		return ScreenNeighborGraph::Direction::kDown;
+	default:
+		return ScreenNeighborGraph::Direction::kTotal;
+	}
+}
 
 DirectionalMovementHandler* DirectionalMovementHandler::GetSingleton()
 {
@@ -48,73 +75,35 @@ void DirectionalMovementHandler::Register()
 	}
 }
 
-constexpr uint32_t hash(const char* data, size_t const size) noexcept
-{
-	uint32_t hash = 5381;
-
-	for (const char* c = data; c < data + size; ++c) {
-		hash = ((hash << 5) + hash) + (unsigned char)*c;
-	}
-
-	return hash;
-}
-
-constexpr uint32_t operator"" _h(const char* str, size_t size) noexcept
-{
-	return hash(str, size);
-}
-
 DirectionalMovementHandler::EventResult DirectionalMovementHandler::ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>*)
 {
 	if (a_event) {
-		std::string_view eventTag = a_event->tag.data();
-
-		switch (hash(eventTag.data(), eventTag.size())) {
-		// Start phase
-		case "CastOKStart"_h:
-		case "preHitFrame"_h:
-		case "MCO_AttackInitiate"_h:
-		case "MCO_PowerAttackInitiate"_h:
-		case "MCO_InputBuffer"_h:
-		case "TDM_AttackStart"_h:
-		case "Collision_AttackStart"_h:
-		case "Collision_Start"_h:
+		const std::string_view eventTag{ a_event->tag.data(), a_event->tag.size() };
+
+		switch (AttackEvents::Lookup(eventTag)) {
+		case AttackEvents::Transition::kStart:
 			if (_attackState != AttackState::kMid) {
 				SetAttackState(AttackState::kStart);
 			}
 			break;
 
-		case "weaponSwing"_h:
-		case "weaponLeftSwing"_h:
-		case "SoundPlay.WPNSwingUnarmed"_h:
-		case "TDM_AttackMid"_h:
-		case "Collision_Add"_h:
+		case AttackEvents::Transition::kMid:
 			if (_attackState != AttackState::kEnd) {
 				SetAttackState(AttackState::kMid);
 			}
 			break;
 
-		case "HitFrame"_h:
-		case "attackWinStart"_h:
-		case "SkySA_AttackWinStart"_h:
-		case "MCO_WinOpen"_h:
-		case "MCO_PowerWinOpen"_h:
-		case "MCO_TransitionOpen"_h:
-		case "MCO_Recovery"_h:
-		case "TDM_AttackEnd"_h:
-		case "Collision_AttackEnd"_h:
+		case AttackEvents::Transition::kEnd:
 			SetAttackState(AttackState::kEnd);
 			break;
 
 		// Back to none
-		case "attackStop"_h:
-		case "TDM_AttackStop"_h:
-		case "SkySA_AttackWinEnd"_h:
-		case "MCO_WinClose"_h:
-		case "MCO_PowerWinClose"_h:
-		case "MCO_TransitionClose"_h:
+		case AttackEvents::Transition::kStop:
 			SetAttackState(AttackState::kNone);
 			break;
+
+		default:
+			break;
 		}
 	}
 
@@ -134,12 +123,40 @@ void DirectionalMovementHandler::Update()
 		return;
 	}
 
+	Profiler::ScopedFrame profileFrame;
+
+	// normally already done by the camera update, this catches whatever was queued after it
+	FinishActorUpdates();
+
+	++_frameCount;
+	_frameContext.Build(_frameCount);
+	{
+		Locker locker(_leaningLock);
+		_leaningFrameContext = _frameContext;
+		_leaningLODScheduler.Update(_frameCount);
+	}
+
+	PruneTargetValidityCache();
+	BoneCache::GetSingleton()->Update(_frameCount);
+	ActorMetadataCache::GetSingleton()->Update(_frameCount);
+	GraphVariableCache::GetSingleton()->Update(_frameCount);
+	{
+		TargetValidityLocker locker(_targetValidityLock);
+		_lineOfSightScheduler.Update(_frameContext.realTimeDeltaTime);
+	}
+
 	Settings::UpdateGlobals();
 
 	ProgressTimers();
 
 	UpdateTargetLock();
 
+	if (auto target = _target.get()) {
+		RE::NiPoint3 linearVelocity;
+		target->GetLinearVelocity(linearVelocity);
+		_targetVelocityEstimator.Update(_target, target->GetPosition(), linearVelocity, _frameCount, *g_deltaTime, Settings::fTargetLockVelocityFilterAlpha, Settings::fTargetLockVelocityFilterBeta);
+	}
+
 	UpdateTweeningState();
 
 	UpdateFacingState();
@@ -162,36 +179,40 @@ void DirectionalMovementHandler::Update()
 	}
 
 	if (IsFreeCamera()) {
-		if (_target) {
-			SetDesiredAngleToTarget(RE::PlayerCharacter::GetSingleton(), _target);
-			LookAtTarget(_target);
-			if (Settings::glob_directionalMovement) {
-				Settings::glob_directionalMovement->value = 0;
-			}
-		} else if (Settings::fMeleeMagnetismAngle > 0.f) {
-			SetDesiredAngleToMagnetismTarget();
-		}		
+		{
+			Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateTargetFacing };
 
-		if (Settings::uDialogueMode == DialogueMode::kFaceSpeaker) {
-			auto newDialogueSpeaker = RE::MenuTopicManager::GetSingleton()->speaker;
+			if (_target) {
+				SetDesiredAngleToTarget(RE::PlayerCharacter::GetSingleton(), _target);
+				LookAtTarget(_target);
+				if (Settings::glob_directionalMovement) {
+					Settings::glob_directionalMovement->value = 0;
+				}
+			} else if (Settings::fMeleeMagnetismAngle > 0.f) {
+				SetDesiredAngleToMagnetismTarget();
+			}		
 
-			if (newDialogueSpeaker != _dialogueSpeaker) {
-				_dialogueSpeaker = newDialogueSpeaker;
-			}
+			if (Settings::uDialogueMode == DialogueMode::kFaceSpeaker) {
+				auto newDialogueSpeaker = RE::MenuTopicManager::GetSingleton()->speaker;
+
+				if (newDialogueSpeaker != _dialogueSpeaker) {
+					_dialogueSpeaker = newDialogueSpeaker;
+				}
 			
-			if (_dialogueSpeaker) {
-				auto dialogueSpeaker = _dialogueSpeaker.get();
-				if (dialogueSpeaker) {
-					auto actorSpeaker = dialogueSpeaker->As<RE::Actor>();
-					if (actorSpeaker) {
-						RE::ActorHandle actorHandle = actorSpeaker->GetHandle();
-						SetDesiredAngleToTarget(RE::PlayerCharacter::GetSingleton(), actorHandle);
-						if (Settings::bHeadtracking && !GetForceDisableHeadtracking()) {
-							auto playerCharacter = RE::PlayerCharacter::GetSingleton();
-							auto currentProcess = playerCharacter->GetActorRuntimeData().currentProcess;
-							if (currentProcess && currentProcess->high) {
-								currentProcess->high->SetHeadtrackTarget(RE::HighProcessData::HEAD_TRACK_TYPE::kCombat, actorSpeaker);
-								RefreshDialogueHeadtrackTimer();
+				if (_dialogueSpeaker) {
+					auto dialogueSpeaker = _dialogueSpeaker.get();
+					if (dialogueSpeaker) {
+						auto actorSpeaker = dialogueSpeaker->As<RE::Actor>();
+						if (actorSpeaker) {
+							RE::ActorHandle actorHandle = actorSpeaker->GetHandle();
+							SetDesiredAngleToTarget(RE::PlayerCharacter::GetSingleton(), actorHandle);
+							if (Settings::bHeadtracking && !GetForceDisableHeadtracking()) {
+								auto playerCharacter = RE::PlayerCharacter::GetSingleton();
+								auto currentProcess = playerCharacter->GetActorRuntimeData().currentProcess;
+								if (currentProcess && currentProcess->high) {
+									currentProcess->high->SetHeadtrackTarget(RE::HighProcessData::HEAD_TRACK_TYPE::kCombat, actorSpeaker);
+									RefreshDialogueHeadtrackTimer();
+								}
 							}
 						}
 					}
@@ -230,6 +251,8 @@ void DirectionalMovementHandler::Update()
 	}
 
 	if (_bResetCamera) {
+		Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateCameraReset };
+
 		auto playerCamera = RE::PlayerCamera::GetSingleton();
 		if (playerCamera->currentState && playerCamera->currentState->id == RE::CameraState::kThirdPerson || playerCamera->currentState->id == RE::CameraState::kMount) {
 			RE::TESObjectREFR* cameraTarget = nullptr;
@@ -246,7 +269,7 @@ void DirectionalMovementHandler::Update()
 			float desiredRotationX = NormalRelativeAngle(_desiredCameraAngleX - cameraTarget->data.angle.z);
 			float desiredRotationY = Settings::bResetCameraPitch ? 0.f : thirdPersonState->freeRotation.y;
 			float desiredTargetPitch = Settings::bResetCameraPitch ? 0.f : cameraTarget->data.angle.x;
-			const float realTimeDeltaTime = GetRealTimeDeltaTime();
+			const float realTimeDeltaTime = _frameContext.realTimeDeltaTime;
 			thirdPersonState->freeRotation.x = InterpAngleTo(thirdPersonState->freeRotation.x, desiredRotationX, realTimeDeltaTime, 10.f);
 			thirdPersonState->freeRotation.y = InterpAngleTo(thirdPersonState->freeRotation.y, desiredRotationY, realTimeDeltaTime, 10.f);
 			cameraTarget->data.angle.x = InterpAngleTo(cameraTarget->data.angle.x, desiredTargetPitch, realTimeDeltaTime, 10.f);
@@ -298,8 +321,16 @@ void DirectionalMovementHandler::Update()
 #endif
 }
 
+void DirectionalMovementHandler::FinishActorUpdates()
+{
+	SolveLeaning();
+	GraphVariableCache::GetSingleton()->Flush();
+}
+
 void DirectionalMovementHandler::UpdateDirectionalMovement()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateDirectionalMovement };
+
 	bool bIsAIDriven = false;
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 	if (playerCharacter) {
@@ -338,6 +369,8 @@ void DirectionalMovementHandler::UpdateDirectionalMovement()
 
 void DirectionalMovementHandler::UpdateFacingState()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateFacingState };
+
 	using Delivery = RE::MagicSystem::Delivery;
 
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
@@ -522,6 +555,8 @@ void DirectionalMovementHandler::UpdateFacingState()
 
 void DirectionalMovementHandler::UpdateFacingCrosshair()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateFacingCrosshair };
+
 	if (_bShouldFaceCrosshair && !_bYawControlledByPlugin)
 	{
 		auto playerCharacter = RE::PlayerCharacter::GetSingleton();
@@ -551,10 +586,15 @@ void DirectionalMovementHandler::UpdateFacingCrosshair()
 
 void DirectionalMovementHandler::UpdateDodgingState()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateDodgingState };
+
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 
 	bool bWasDodging = _bIsDodging;
-	playerCharacter->GetGraphVariableBool("TDM_Dodge", _bIsDodging);
+	GraphVariableCache::Variables graphVariables;
+	if (GraphVariableCache::GetSingleton()->Get(playerCharacter, graphVariables)) {
+		graphVariables.GetBool(GraphVariableCache::Variable::kDodge, _bIsDodging);
+	}
 
 	_bJustDodged = !bWasDodging && _bIsDodging;
 
@@ -566,6 +606,8 @@ void DirectionalMovementHandler::UpdateDodgingState()
 
 void DirectionalMovementHandler::UpdateJumpingState()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateJumpingState };
+
 	auto playerController = RE::PlayerCharacter::GetSingleton()->GetCharController();
 	if (playerController && Is360Movement()) {
 		if (playerController->wantState == RE::hkpCharacterStateType::kJumping) {
@@ -578,12 +620,14 @@ void DirectionalMovementHandler::UpdateSwimmingPitchOffset()
 {
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 	if (playerCharacter && playerCharacter->AsActorState()->IsSwimming()) {
-		_currentSwimmingPitchOffset = InterpTo(_currentSwimmingPitchOffset, _desiredSwimmingPitchOffset, GetPlayerDeltaTime(), Settings::fSwimmingPitchSpeed);
+		_currentSwimmingPitchOffset = InterpTo(_currentSwimmingPitchOffset, _desiredSwimmingPitchOffset, _frameContext.playerDeltaTime, Settings::fSwimmingPitchSpeed);
 	}
 }
 
 void DirectionalMovementHandler::UpdateMountedArchery()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateMountedArchery };
+
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 
 	bool bEnable = IsMountedArcheryPatchInstalled(playerCharacter);
@@ -613,8 +657,10 @@ void DirectionalMovementHandler::UpdateMountedArchery()
 
 void DirectionalMovementHandler::ProgressTimers()
 {
-	const float playerDeltaTime = GetPlayerDeltaTime();
-	const float realTimeDeltaTime = GetRealTimeDeltaTime();
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kProgressTimers };
+
+	const float playerDeltaTime = _frameContext.playerDeltaTime;
+	const float realTimeDeltaTime = _frameContext.realTimeDeltaTime;
 	if (_dialogueHeadtrackTimer > 0.f) {
 		_dialogueHeadtrackTimer -= playerDeltaTime;
 	}
@@ -643,15 +689,41 @@ void DirectionalMovementHandler::ProgressTimers()
 
 void DirectionalMovementHandler::UpdateProjectileTargetMap()
 {
-	if (!_projectileTargets.empty()) {
-		for (auto it = _projectileTargets.begin(), next_it = it; it != _projectileTargets.end(); it = next_it) {
-			++next_it;
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateProjectileTargetMap };
 
-			if (!it->first) {
-				_projectileTargets.erase(it);
-			}
+	// a full pass over the table every 16 frames, inserts expire the rest on demand
+	_projectileTargets.Expire(64);
+}
+
+void DirectionalMovementHandler::UpdateProjectileGuidance()
+{
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateProjectileGuidance };
+
+	_projectileGuidanceFrame = _frameCount;
+
+	// most projectiles share the current target point, only read its transform when it changes
+	RE::NiAVObject* lastTargetPoint = nullptr;
+	RE::NiPoint3 targetPosition;
+
+	_projectileTargets.ForEach([&](RE::ObjectRefHandle a_projectileHandle, RE::NiAVObject* a_targetPoint, ProjectileGuidance& a_guidance) {
+		if (!a_targetPoint) {
+			return;
 		}
-	}
+
+		auto projectileRef = a_projectileHandle.get();
+		auto projectile = projectileRef ? skyrim_cast<RE::Projectile*>(projectileRef.get()) : nullptr;
+		if (!projectile || GetProjectileAimType(projectile) != TargetLockProjectileAimType::kHoming) {
+			return;
+		}
+
+		if (a_targetPoint != lastTargetPoint) {
+			lastTargetPoint = a_targetPoint;
+			targetPosition = a_targetPoint->world.translate;
+		}
+
+		a_guidance.Compute(projectile->data.location, targetPosition);
+		a_guidance.frame = _frameCount;
+	});
 }
 
 void DirectionalMovementHandler::UpdateLeaning(RE::Actor* a_actor, [[maybe_unused]] float a_deltaTime)
@@ -678,70 +750,128 @@ void DirectionalMovementHandler::UpdateLeaning(RE::Actor* a_actor, [[maybe_unuse
 		return;
 	}
 
-	RE::NiPoint3 previousVelocity;
-	bool bFound = a_actor->GetGraphVariableFloat("TDM_VelocityX", previousVelocity.x);
+	using Variable = GraphVariableCache::Variable;
+
+	GraphVariableCache::Variables graphVariables;
+	if (!GraphVariableCache::GetSingleton()->Get(a_actor, graphVariables)) {
+		return;
+	}
+
+	RE::NiPoint2 previousVelocity;
+	bool bFound = graphVariables.GetFloat(Variable::kVelocityX, previousVelocity.x);
 	if (!bFound) {
 		return;
 	}
-	a_actor->GetGraphVariableFloat("TDM_VelocityY", previousVelocity.y);
+	graphVariables.GetFloat(Variable::kVelocityY, previousVelocity.y);
 
-	float desiredPitch = 0.f;
-	float desiredRoll = 0.f;
+	float pitch = 0.f;
+	float roll = 0.f;
+	graphVariables.GetFloat(Variable::kPitch, pitch);
+	graphVariables.GetFloat(Variable::kRoll, roll);
 
-	const float playerDeltaTime = GetPlayerDeltaTime();
+	const auto forwardVector = VectorMath::Load(characterController->forwardVec);
+	const bool bAttacking = a_actor->AsActorState()->actorState1.meleeAttackState != RE::ATTACK_STATE_ENUM::kNone;
+	const auto actorHandle = a_actor->GetHandle();
 
-	if (a_actor->AsActorState()->actorState1.meleeAttackState == RE::ATTACK_STATE_ENUM::kNone) {
-		float quad[4];
-		_mm_store_ps(quad, characterController->forwardVec.quad);
-		RE::NiPoint3 worldVelocity{ -quad[0], -quad[1], 0.f };
-		RE::NiPoint3 upVector{ 0.f, 0.f, 1.f };
+	// the LOD, the scheduling and the batch under one lock, the actor updates can run on several threads
+	Locker locker(_leaningLock);
 
-		worldVelocity *= characterController->speedPct * Settings::fLeaningMult;
+	const auto lodLevel = GetLeaningLODLevel(a_actor, _leaningFrameContext);
+	float deltaTime = 0.f;
+	bool bResumed = false;
+	if (!_leaningLODScheduler.Schedule(actorHandle.native_handle(), lodLevel, Settings::uLeaningLODInterval, _leaningFrameContext.playerDeltaTime, deltaTime, std::addressof(bResumed))) {
+		return;
+	}
 
-		a_actor->SetGraphVariableFloat("TDM_VelocityX", worldVelocity.x);
-		a_actor->SetGraphVariableFloat("TDM_VelocityY", worldVelocity.y);
+	const bool bFrozen = lodLevel == LeaningLODScheduler::Level::kFrozen;
+	if (bFrozen && std::fabs(pitch) < _leaningUprightTolerance && std::fabs(roll) < _leaningUprightTolerance) {  // nothing left to decay
+		return;
+	}
 
-		// calculate acceleration
-		RE::NiPoint3 worldAcceleration = RE::NiPoint3::Zero();
-		
-		if (playerDeltaTime > 0.f) {
-			worldAcceleration = (worldVelocity - previousVelocity) / playerDeltaTime;
+	// solved and written back with the rest once the frame's actor updates are done, see FinishActorUpdates. A frozen actor's velocity wasn't
+	// written while it was upright, leaning into the difference from it would pop.
+	_leaningBatch.Add({ VectorMath::GetX(forwardVector), VectorMath::GetY(forwardVector) }, characterController->speedPct, a_actor->data.angle.z, deltaTime, previousVelocity, pitch, roll, bFrozen || bAttacking, bResumed);
+	_leaningActors.push_back(actorHandle);
+}
+
+void DirectionalMovementHandler::SolveLeaning()
+{
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kSolveLeaning };
+
+	Locker locker(_leaningLock);
+
+	if (_leaningBatch.GetSize() == 0) {
+		return;
+	}
+
+	Profiler::Count(Profiler::Counter::kLeaningSolved, _leaningBatch.GetSize());
+
+	LeaningBatch::Parameters parameters;
+	parameters.leaningMult = Settings::fLeaningMult;
+	parameters.leaningSpeed = Settings::fLeaningSpeed;
+	parameters.maxLeaningStrength = Settings::fMaxLeaningStrength;
+
+	_leaningBatch.Solve(parameters);
+
+	using Variable = GraphVariableCache::Variable;
+
+	// the cache drops the writes of actors that were invalidated or had their graph swapped since they were gathered
+	auto graphVariableCache = GraphVariableCache::GetSingleton();
+	for (std::uint32_t i = 0; i < _leaningBatch.GetSize(); ++i) {
+		// update angles
+		const float roll = _leaningBatch.GetRoll(i);
+		std::array<GraphVariableCache::Write, 5> writes{ { { Variable::kPitch, _leaningBatch.GetPitch(i) }, { Variable::kRoll, roll }, { Variable::kSpineTurn, roll } } };
+		std::size_t writeCount = 3;
+
+		if (_leaningBatch.HasVelocity(i)) {
+			const auto velocity = _leaningBatch.GetVelocity(i);
+			writes[writeCount++] = { Variable::kVelocityX, velocity.x };
+			writes[writeCount++] = { Variable::kVelocityY, velocity.y };
 		}
 
-		worldAcceleration *= worldAcceleration.Dot(worldVelocity) > 0 ? 1.f : 0.5f;
-		worldAcceleration = ClampSizeMax(worldAcceleration, Settings::fMaxLeaningStrength);  // clamp to sane values
-		auto acceleration = RotateAngleAxis(worldAcceleration, a_actor->data.angle.z, upVector);
+		graphVariableCache->SetFloats(_leaningActors[i], { writes.data(), writeCount });
+	}
 
-		// get desired lean
-		desiredPitch = acceleration.y;
-		desiredRoll = acceleration.x;
+	_leaningBatch.Clear();
+	_leaningActors.clear();
+}
+
+LeaningLODScheduler::Level DirectionalMovementHandler::GetLeaningLODLevel(RE::Actor* a_actor, const FrameContext& a_frameContext)
+{
+	using Level = LeaningLODScheduler::Level;
+
+	if (!Settings::bEnableLeaningLOD || a_actor->IsPlayerRef()) {
+		return Level::kFull;
+	}
 
-//#ifndef NDEBUG
-//		if (g_trueHUD) {
-//			RE::NiPoint3 rootPos = a_actor->GetPosition();
-//			RE::NiPoint3 pos = rootPos + RE::NiPoint3{ 0.f, 0.f, 50.f };
-//			g_trueHUD->DrawArrow(rootPos, rootPos + worldVelocity);
-//			g_trueHUD->DrawArrow(pos, pos + worldAcceleration, 10.f, 0.f, 0xFFFF00FF);
-//		}
-//#endif
+	RE::NiPoint3 position = a_actor->GetPosition();
+	const float distanceSquared = position.GetSquaredDistance(a_frameContext.cameraPosition);
+	if (distanceSquared > Settings::fLeaningLODMaxDistance * Settings::fLeaningLODMaxDistance) {
+		return Level::kFrozen;
 	}
 
-	float pitch, roll;
-	a_actor->GetGraphVariableFloat("TDM_Pitch", pitch);
-	a_actor->GetGraphVariableFloat("TDM_Roll", roll);
+	// test the middle of the body against a slightly larger screen, so actors at the edges still lean
+	position.z += _leaningLODBodyHeight;
+	RE::NiPoint2 screenPosition;
+	float depth = -1.f;
+	a_frameContext.WorldPtToScreenPt3(position, screenPosition, depth);
+	if (depth < 0.f ||
+		screenPosition.x < -_leaningLODScreenMargin || screenPosition.x > 1.f + _leaningLODScreenMargin ||
+		screenPosition.y < -_leaningLODScreenMargin || screenPosition.y > 1.f + _leaningLODScreenMargin) {
+		return Level::kFrozen;
+	}
 
-	// interpolate
-	roll = InterpTo(roll, desiredRoll, playerDeltaTime, Settings::fLeaningSpeed);
-	pitch = InterpTo(pitch, desiredPitch, playerDeltaTime, Settings::fLeaningSpeed);
+	if (distanceSquared > Settings::fLeaningLODFullRateDistance * Settings::fLeaningLODFullRateDistance) {
+		return Level::kReduced;
+	}
 
-	// update angles
-	a_actor->SetGraphVariableFloat("TDM_Pitch", pitch);
-	a_actor->SetGraphVariableFloat("TDM_Roll", roll);
-	a_actor->SetGraphVariableFloat("TDM_SpineTurn", roll);
+	return Level::kFull;
 }
 
 void DirectionalMovementHandler::UpdateCameraAutoRotation()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateCameraAutoRotation };
+
 	auto playerCamera = RE::PlayerCamera::GetSingleton();
 	if (playerCamera && playerCamera->currentState && (playerCamera->currentState->id == RE::CameraState::kThirdPerson || playerCamera->currentState->id == RE::CameraState::kMount)) {
 		RE::Actor* cameraTarget = nullptr;
@@ -776,7 +906,7 @@ void DirectionalMovementHandler::UpdateCameraAutoRotation()
 			}
 		}
 
-		const float realTimeDeltaTime = GetRealTimeDeltaTime();
+		const float realTimeDeltaTime = _frameContext.realTimeDeltaTime;
 		_currentAutoCameraRotationSpeed = InterpTo(_currentAutoCameraRotationSpeed, desiredSpeed, realTimeDeltaTime, 5.f);
 		thirdPersonState->freeRotation.x += _currentAutoCameraRotationSpeed * realTimeDeltaTime;
 	}
@@ -935,14 +1065,7 @@ bool DirectionalMovementHandler::ProcessInput(RE::NiPoint2& a_inputDirection, RE
 		SetLastInputDirection(normalizedInputDirection);
 	}
 	
-	RE::NiPoint2 forwardVector(0.f, 1.f);
-	RE::NiPoint2 characterDirection = Vec2Rotate(forwardVector, currentCharacterRot);
-	RE::NiPoint2 cameraRelativeInputDirection = Vec2Rotate(a_inputDirection, -currentCameraRotOffset);
-
-	RE::NiPoint2 worldRelativeInputDirection = Vec2Rotate(cameraRelativeInputDirection, currentCharacterRot);
-
-	RE::NiPoint2 normalizedWorldRelativeInputDirection = worldRelativeInputDirection;
-	normalizedWorldRelativeInputDirection.Unitize();
+	auto [characterDirection, cameraRelativeInputDirection, normalizedWorldRelativeInputDirection] = GetMovementInputDirections(a_inputDirection, currentCharacterRot, currentCameraRotOffset);
 
 	if (normalizedInputDirection.x == 0.f && normalizedInputDirection.y == 0.f) {
 		a_playerControlsData->prevMoveVec = a_playerControlsData->moveInputVec;
@@ -1011,7 +1134,10 @@ void DirectionalMovementHandler::SetDesiredAngleToTarget(RE::PlayerCharacter* a_
 	}
 
 	bool bIsDodging = false;
-	a_playerCharacter->GetGraphVariableBool("TDM_Dodge", bIsDodging);
+	GraphVariableCache::Variables graphVariables;
+	if (GraphVariableCache::GetSingleton()->Get(a_playerCharacter, graphVariables)) {
+		graphVariables.GetBool(GraphVariableCache::Variable::kDodge, bIsDodging);
+	}
 	if (a_playerCharacter->GetPlayerRuntimeData().playerFlags.isSprinting || bIsDodging) {
 		return;
 	}
@@ -1051,6 +1177,8 @@ void DirectionalMovementHandler::SetDesiredAngleToTarget(RE::PlayerCharacter* a_
 
 void DirectionalMovementHandler::UpdateRotation(bool bForceInstant /*= false */)
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateRotation };
+
 	if (_desiredAngle < 0.f) {
 		return;
 	}
@@ -1069,7 +1197,7 @@ void DirectionalMovementHandler::UpdateRotation(bool bForceInstant /*= false */)
 
 	bool bInstantRotation = bForceInstant || (_bShouldFaceCrosshair && Settings::bFaceCrosshairInstantly) || (_bShouldFaceCrosshair && !_bCurrentlyTurningToCrosshair) || (_bJustDodged && !playerCharacter->IsAnimationDriven()) || (_bYawControlledByPlugin && _controlledYawRotationSpeedMultiplier <= 0.f);
 
-	const float playerDeltaTime = GetPlayerDeltaTime();
+	const float playerDeltaTime = _frameContext.playerDeltaTime;
 
 	if (!bInstantRotation) {
 		if (IsPlayerAnimationDriven() || _bIsDodging || IsTDMRotationLocked()) {
@@ -1189,6 +1317,8 @@ void DirectionalMovementHandler::UpdateRotation(bool bForceInstant /*= false */)
 
 void DirectionalMovementHandler::UpdateRotationLockedCam()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateRotationLockedCam };
+
 	if (_bIsAiming) {
 		return;
 	}
@@ -1204,15 +1334,15 @@ void DirectionalMovementHandler::UpdateRotationLockedCam()
 		return;
 	}
 
-	RE::NiPoint3 playerPos;
-	if (!GetTorsoPos(playerCharacter, playerPos)) {
+	if (!_frameContext.bHasTorsoPosition) {
 		return;
 	}
+	const RE::NiPoint3 playerPos = _frameContext.torsoPosition;
 
 	float currentCharacterYaw = playerCharacter->data.angle.z;
 	float currentCharacterPitch = playerCharacter->data.angle.x;
 
-	RE::NiPoint3 cameraPos = GetCameraPos();
+	const RE::NiPoint3 cameraPos = _frameContext.cameraPosition;
 
 	RE::NiPoint3 playerToTarget = RE::NiPoint3(-(targetPos.x - playerPos.x), targetPos.y - playerPos.y, targetPos.z - playerPos.z);
 	RE::NiPoint3 playerDirectionToTarget = playerToTarget;
@@ -1228,7 +1358,7 @@ void DirectionalMovementHandler::UpdateRotationLockedCam()
 	float angleDelta = GetAngle(currentPlayerDirection, playerDirectionToTargetXY);
 	angleDelta = NormalRelativeAngle(angleDelta);
 
-	const float realTimeDeltaTime = GetRealTimeDeltaTime();
+	const float realTimeDeltaTime = _frameContext.realTimeDeltaTime;
 
 	float desiredCharacterYaw = currentCharacterYaw + angleDelta;
 	playerCharacter->SetRotationZ(InterpAngleTo(currentCharacterYaw, desiredCharacterYaw, realTimeDeltaTime, Settings::fTargetLockYawAdjustSpeed));
@@ -1242,6 +1372,8 @@ void DirectionalMovementHandler::UpdateRotationLockedCam()
 
 void DirectionalMovementHandler::UpdateTweeningState()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateTweeningState };
+
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 	if (playerCharacter) {
 		auto movementController = playerCharacter->GetActorRuntimeData().movementController;
@@ -1337,7 +1469,10 @@ bool DirectionalMovementHandler::IsTDMRotationLocked() const
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 	if (playerCharacter) {
 		bool result = false;
-		playerCharacter->GetGraphVariableBool("TDM_LockRotation", result);
+		GraphVariableCache::Variables graphVariables;
+		if (GraphVariableCache::GetSingleton()->Get(playerCharacter, graphVariables)) {
+			graphVariables.GetBool(GraphVariableCache::Variable::kLockRotation, result);
+		}
 		return result;
 	}
 	
@@ -1405,7 +1540,8 @@ bool DirectionalMovementHandler::ToggleTargetLock(bool bEnable, bool bPressedMan
 			return false;
 		}
 
-		RE::ActorHandle actor = FindTarget(bPressedManually ? TargetLockSelectionMode::kCombined : TargetLockSelectionMode::kClosest);
+		const auto manualSelectionMode = Settings::bTargetLockWeightedSelection ? TargetLockSelectionMode::kWeighted : TargetLockSelectionMode::kCombined;
+		RE::ActorHandle actor = FindTarget(bPressedManually ? manualSelectionMode : TargetLockSelectionMode::kClosest);
 		if (actor) 
 		{
 			SetTarget(actor);
@@ -1547,10 +1683,11 @@ bool DirectionalMovementHandler::CheckCurrentTarget(RE::ActorHandle a_target, bo
 
 	auto actorState = target->AsActorState();
 	auto currentProcess = target->GetActorRuntimeData().currentProcess;
+	auto metadata = ActorMetadataCache::GetSingleton()->Get(target.get());
 	if (!currentProcess || !currentProcess->InHighProcess() ||
 		target->IsDead() ||
-		(actorState->IsBleedingOut() && target->IsEssential()) ||
-		target->GetPosition().GetDistance(playerCharacter->GetPosition()) > (Settings::fTargetLockDistance * GetTargetLockDistanceRaceSizeMultiplier(target->GetRace()) * _targetLockDistanceHysteresis) ||
+		(actorState->IsBleedingOut() && metadata.bEssential) ||
+		target->GetPosition().GetDistance(playerCharacter->GetPosition()) > (Settings::fTargetLockDistance * metadata.targetLockDistanceMultiplier * _targetLockDistanceHysteresis) ||
 		target->AsActorValueOwner()->GetActorValue(RE::ActorValue::kInvisibility) > 0 ||
 		//RE::UI::GetSingleton()->IsMenuOpen("Dialogue Menu"))
 		RE::MenuTopicManager::GetSingleton()->speaker)
@@ -1574,10 +1711,12 @@ bool DirectionalMovementHandler::CheckCurrentTarget(RE::ActorHandle a_target, bo
 		}
 		else 
 		{
-			auto timeNow = std::chrono::system_clock::now();
-
-			bool r8 = false;
-			bool bHasLOS = playerCharacter->HasLineOfSight(a_target.get().get(), r8);
+			// the locked target is always tested once its last result went stale, the lost sight grace period covers the reuse
+			bool bHasLOS = false;
+			{
+				TargetValidityLocker locker(_targetValidityLock);
+				bHasLOS = _lineOfSightScheduler.Query(target.get(), true).value_or(false);
+			}
 			if (bHasLOS) {
 				_lastLOSTimer = _lostSightAllowedDuration;
 			}
@@ -1593,6 +1732,8 @@ bool DirectionalMovementHandler::CheckCurrentTarget(RE::ActorHandle a_target, bo
 
 void DirectionalMovementHandler::UpdateTargetLock()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateTargetLock };
+
 	if (HasTargetLocked())
 	{		
 		auto playerCamera = RE::PlayerCamera::GetSingleton();
@@ -1608,13 +1749,156 @@ void DirectionalMovementHandler::UpdateTargetLock()
 	}
 }
 
+void DirectionalMovementHandler::UpdateTargetSwitchGraphs()
+{
+	// gathered on a switch input, at most once a frame
+	if (_bTargetSwitchGraphsValid && _targetSwitchGraphFrame == _frameCount && _targetSwitchGraphTarget == _target) {
+		return;
+	}
+
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateTargetSwitchGraphs };
+
+	_bTargetSwitchGraphsValid = false;
+
+	if (!HasTargetLocked() || !_frameContext.bHasTorsoPosition) {
+		return;
+	}
+
+	const RE::NiPoint3& playerPosition = _frameContext.torsoPosition;
+	RE::NiPoint2 screenPosition;
+	float depth;
+
+	// candidates, with the locked target first
+	_targetSwitchGraph.Clear();
+	_targetSwitchGraphActors.clear();
+	_targetSwitchGraphIndices.clear();
+
+	_frameContext.WorldPtToScreenPt3(GetTargetPosition(), screenPosition, depth);
+	_targetSwitchGraphIndices.emplace(_target, _targetSwitchGraph.AddNode(screenPosition, depth >= 0.f));
+	_targetSwitchGraphActors.push_back(_target);
+
+	// candidates in range are gathered first and projected to the screen together
+	_targetSwitchGraphCandidates.clear();
+	_targetSwitchGraphPositions.clear();
+
+	const auto playerVector = VectorMath::Load(playerPosition);
+	auto& targetCandidates = GetTargetCandidates();
+	targetCandidates.ForEachInRadius(playerPosition, targetCandidates.GetMaxDistance() + targetPointQuerySlack, [&](TargetCandidate& a_candidate) {
+		if (a_candidate.handle == _target) {
+			return;
+		}
+
+		ResolveTargetPoint(a_candidate);
+
+		if (VectorMath::LengthSquared(VectorMath::Subtract(VectorMath::Load(a_candidate.targetPosition), playerVector)) > a_candidate.maxDistance * a_candidate.maxDistance) {
+			return;
+		}
+
+		_targetSwitchGraphCandidates.push_back(a_candidate.handle);
+		_targetSwitchGraphPositions.push_back(a_candidate.targetPosition);
+	});
+
+	_targetSwitchGraphScreenPositions.resize(_targetSwitchGraphPositions.size());
+	_targetSwitchGraphDepths.resize(_targetSwitchGraphPositions.size());
+	_frameContext.WorldPtsToScreenPts3(_targetSwitchGraphPositions, _targetSwitchGraphScreenPositions, _targetSwitchGraphDepths);
+
+	for (std::size_t i = 0; i < _targetSwitchGraphCandidates.size(); ++i) {
+		if (_targetSwitchGraphDepths[i] < 0.f) {  // offscreen
+			continue;
+		}
+
+		_targetSwitchGraphIndices.emplace(_targetSwitchGraphCandidates[i], _targetSwitchGraph.AddNode(_targetSwitchGraphScreenPositions[i], true));
+		_targetSwitchGraphActors.push_back(_targetSwitchGraphCandidates[i]);
+	}
+
+	// target points of the locked target
+	_targetPointSwitchGraph.Clear();
+	_targetPointSwitchGraphPoints.clear();
+
+	for (auto& targetPoint : GetTargetPoints(_target)) {
+		if (!targetPoint) {
+			continue;
+		}
+
+		_frameContext.WorldPtToScreenPt3(targetPoint->world.translate, screenPosition, depth);
+		_targetPointSwitchGraph.AddNode(screenPosition, depth >= 0.f);
+		_targetPointSwitchGraphPoints.push_back(targetPoint);
+	}
+
+	_targetSwitchGraphTarget = _target;
+	_targetSwitchGraphFrame = _frameCount;
+	_bTargetSwitchGraphsValid = true;
+}
+
 bool DirectionalMovementHandler::IsActorValidTarget(RE::ActorPtr a_actor, bool a_bCheckDistance /*= false*/) const
+{
+	if (!IsActorValidTargetCandidate(a_actor))
+		return false;
+
+	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
+
+	if (a_bCheckDistance && a_actor->GetPosition().GetDistance(playerCharacter->GetPosition()) > Settings::fTargetLockDistance * ActorMetadataCache::GetSingleton()->Get(a_actor.get()).targetLockDistanceMultiplier)
+		return false;
+
+	// only ever asked on behalf of a player action, never deferred
+	return HasLineOfSightToTarget(a_actor.get(), true);
+}
+
+bool DirectionalMovementHandler::IsActorValidTargetCandidate(RE::ActorPtr a_actor) const
 {
 	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 
 	if (!a_actor || !a_actor.get() || !playerCharacter || a_actor.get() == playerCharacter)
 		return false;
 
+	TargetValidityLocker locker(_targetValidityLock);
+
+	auto& validity = GetTargetValidity(a_actor.get());
+	if (validity.bCandidateResolved) {
+		Profiler::Count(Profiler::Counter::kTargetValidityHit);
+		return validity.bCandidate;
+	}
+
+	Profiler::Count(Profiler::Counter::kTargetValidityMiss);
+	validity.bCandidate = CheckTargetCandidate(a_actor);
+	validity.bCandidateResolved = true;
+
+	return validity.bCandidate;
+}
+
+bool DirectionalMovementHandler::HasLineOfSightToTarget(RE::Actor* a_actor, bool a_bPriority /*= false*/) const
+{
+	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
+	if (!playerCharacter || !a_actor) {
+		return false;
+	}
+
+	TargetValidityLocker locker(_targetValidityLock);
+
+	auto& validity = GetTargetValidity(a_actor);
+	if (validity.bLineOfSightResolved) {
+		Profiler::Count(Profiler::Counter::kTargetValidityHit);
+		Profiler::Count(Profiler::Counter::kLineOfSightSaved);
+		return validity.bLineOfSight;
+	}
+
+	Profiler::Count(Profiler::Counter::kTargetValidityMiss);
+	auto bHasLOS = _lineOfSightScheduler.Query(a_actor, a_bPriority || a_actor->GetHandle() == _target);
+	if (!bHasLOS) {
+		// out of budget, left unresolved so a priority query later this frame still tests it. Until then the last known result stands in
+		return _lineOfSightScheduler.GetLastResult(a_actor).value_or(false);
+	}
+
+	validity.bLineOfSight = *bHasLOS;
+	validity.bLineOfSightResolved = true;
+
+	return validity.bLineOfSight;
+}
+
+bool DirectionalMovementHandler::CheckTargetCandidate(RE::ActorPtr a_actor) const
+{
+	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
+
 	RE::ActorPtr playerMount = nullptr;
 	if (playerCharacter->GetMount(playerMount) && playerMount == a_actor)
 		return false;
@@ -1625,10 +1909,9 @@ bool DirectionalMovementHandler::IsActorValidTarget(RE::ActorPtr a_actor, bool a
 	if (a_actor->IsDead())
 		return false;
 
-	if (a_actor->AsActorState()->IsBleedingOut() && a_actor->IsEssential())
-		return false;
+	auto metadata = ActorMetadataCache::GetSingleton()->Get(a_actor.get());
 
-	if (a_bCheckDistance && a_actor->GetPosition().GetDistance(playerCharacter->GetPosition()) > Settings::fTargetLockDistance * GetTargetLockDistanceRaceSizeMultiplier(a_actor->GetRace()))
+	if (a_actor->AsActorState()->IsBleedingOut() && metadata.bEssential)
 		return false;
 
 	if (a_actor->AsActorValueOwner()->GetActorValue(RE::ActorValue::kInvisibility) > 0)
@@ -1637,16 +1920,79 @@ bool DirectionalMovementHandler::IsActorValidTarget(RE::ActorPtr a_actor, bool a
 	/*if (a_actor->IsPlayerTeammate())
 		return false;*/
 
-	if (Settings::bTargetLockHostileActorsOnly && !a_actor->IsHostileToActor(playerCharacter))
+	if (Settings::bTargetLockHostileActorsOnly && !metadata.bHostileToPlayer)
 		return false;
 
-	bool r8 = false;
-	bool bHasLOS = playerCharacter->HasLineOfSight(a_actor.get(), r8);
+	return true;
+}
 
-	if (!bHasLOS)
-		return false;
+DirectionalMovementHandler::TargetValidity& DirectionalMovementHandler::GetTargetValidity(RE::Actor* a_actor) const
+{
+	auto& validity = _targetValidityCache[a_actor->GetHandle()];
+	if (validity.frame != _frameCount) {
+		validity = TargetValidity{ _frameCount };
+	}
 
-	return true;
+	return validity;
+}
+
+void DirectionalMovementHandler::PruneTargetValidityCache()
+{
+	TargetValidityLocker locker(_targetValidityLock);
+
+	// entries are reset in place when they go stale, only drop actors that haven't been looked at for a while
+	constexpr std::uint32_t maxAge = 60;
+	std::erase_if(_targetValidityCache, [&](const auto& a_entry) { return _frameCount - a_entry.second.frame > maxAge; });
+}
+
+void DirectionalMovementHandler::InvalidateTargetCandidate(RE::TESObjectREFR* a_refr)
+{
+	// the other actors' checks still hold. The entry goes first, a rebuild racing with this must not pick the old one up again.
+	if (auto actor = a_refr ? a_refr->As<RE::Actor>() : nullptr) {
+		TargetValidityLocker locker(_targetValidityLock);
+		_targetValidityCache.erase(actor->GetHandle());
+	}
+
+	_bTargetCandidatesValid = false;
+}
+
+TargetCandidateIndex& DirectionalMovementHandler::GetTargetCandidates()
+{
+	if (_bTargetCandidatesValid && _targetCandidatesFrame == _frameCount) {
+		return _targetCandidates;
+	}
+
+	_targetCandidates.Clear();
+	_targetCandidatesFrame = _frameCount;
+	_bTargetCandidatesValid = true;
+
+	// only the cheap checks here, line of sight is left to the consumers so it's only tested for candidates that are actually in range
+	for (auto& actorHandle : RE::ProcessLists::GetSingleton()->highActorHandles) {
+		auto actor = actorHandle.get();
+		if (IsActorValidTargetCandidate(actor)) {
+			TargetCandidate candidate;
+			candidate.handle = actorHandle;
+			candidate.actor = actor;
+			candidate.position = actor->GetPosition();
+			candidate.maxDistance = Settings::fTargetLockDistance * ActorMetadataCache::GetSingleton()->Get(actor.get()).targetLockDistanceMultiplier;
+			_targetCandidates.Insert(std::move(candidate));
+		}
+	}
+
+	_targetCandidates.Build();
+
+	return _targetCandidates;
+}
+
+void DirectionalMovementHandler::ResolveTargetPoint(TargetCandidate& a_candidate) const
+{
+	if (a_candidate.bTargetPointResolved) {
+		return;
+	}
+
+	a_candidate.targetPoint = GetBestTargetPoint(a_candidate.handle);
+	a_candidate.targetPosition = a_candidate.targetPoint ? a_candidate.targetPoint->world.translate : a_candidate.actor->GetLookingAtLocation();
+	a_candidate.bTargetPointResolved = true;
 }
 
 RE::ActorHandle DirectionalMovementHandler::FindTarget(TargetLockSelectionMode a_mode, bool a_bSkipCurrent /*= true*/)
@@ -1660,89 +2006,51 @@ RE::ActorHandle DirectionalMovementHandler::FindTarget(TargetLockSelectionMode a
 		}
 	}
 
-	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
-	RE::NiPoint3 playerPosition;
-	if (!GetTorsoPos(playerCharacter, playerPosition)) {
+	auto playerCharacter = _frameContext.playerCharacter;
+	if (!playerCharacter || !_frameContext.bHasTorsoPosition) {
 		return RE::ActorHandle();
 	}
-	auto playerCamera = RE::PlayerCamera::GetSingleton();
-	auto& currentCameraState = playerCamera->currentState;
-	if (!currentCameraState) {
+	const RE::NiPoint3 playerPosition = _frameContext.torsoPosition;
+	if (!_frameContext.playerCamera || !_frameContext.playerCamera->currentState) {
 		return RE::ActorHandle();
 	}
 
-	auto& actorHandles = RE::ProcessLists::GetSingleton()->highActorHandles;
-	if (actorHandles.size() == 0) {
+	auto& targetCandidates = GetTargetCandidates();
+	if (targetCandidates.IsEmpty()) {
 		return RE::ActorHandle();
 	}
 
-	RE::NiPoint3 forwardVector(0.f, 1.f, 0.f);
-	//RE::NiPoint3 cameraPosition = playerCamera->pos;
-	//RE::NiPoint3 cameraAngle = GetCameraRotation();
-	
-	RE::ActorHandle bestTarget;
-	float bestDistance = FLT_MAX;
-	float bestDot = -1.f;
-	float bestCombined = FLT_MAX;
-
-	auto getDot = [&](RE::NiPoint3 a_directionVector) {
-		RE::NiQuaternion cameraRotation;
-		currentCameraState->GetRotation(cameraRotation);
-		auto cameraForwardVector = RotateVector(forwardVector, cameraRotation);
-		cameraForwardVector.z = 0.f;
-		cameraForwardVector.Unitize();
-
-		return cameraForwardVector.Dot(a_directionVector);
-	};
-
-	for (auto& actorHandle : actorHandles) {
-		auto actor = actorHandle.get();
-		if (a_bSkipCurrent && actorHandle == _target) {
-		    continue;
+	const RE::NiPoint3& cameraForwardVector = _frameContext.cameraForwardVector;
+
+	const bool bWeighted = a_mode == TargetLockSelectionMode::kWeighted;
+
+	_targetScoringBatch.Clear();
+	_targetScoringCandidates.clear();
+	targetCandidates.ForEachInRadius(playerPosition, targetCandidates.GetMaxDistance() + targetPointQuerySlack, [&](TargetCandidate& a_candidate) {
+		if (a_bSkipCurrent && a_candidate.handle == _target) {
+			return;
 		}
-		if (IsActorValidTarget(actor)) {
-			float targetLockMaxDistance = Settings::fTargetLockDistance * GetTargetLockDistanceRaceSizeMultiplier(actor->GetRace());
-			
-			auto targetPoint = GetBestTargetPoint(actorHandle);
 
-			RE::NiPoint3 actorPosition = targetPoint ? targetPoint->world.translate : actor->GetLookingAtLocation();
-			RE::NiPoint3 directionVector = actorPosition - playerPosition;
+		ResolveTargetPoint(a_candidate);
 
-			float distance = directionVector.Unitize();
-			
-			if (distance <= targetLockMaxDistance) {
-				switch (a_mode) {
-				case TargetLockSelectionMode::kClosest:
-					if (distance < bestDistance) {
-						bestDistance = distance;
-						bestTarget = actorHandle;
-					}
-					break;
-				case TargetLockSelectionMode::kCenter:
-					{
-						float dot = getDot(directionVector);
-						if (dot > bestDot) {
-							bestDot = dot;
-							bestTarget = actorHandle;
-						}
-						break;
-					}					
-				case TargetLockSelectionMode::kCombined:
-					{
-						float dot = getDot(directionVector);
-						float combined = distance * (1.f - dot);
-						if (combined < bestCombined) {
-							bestCombined = combined;
-							bestTarget = actorHandle;
-						}
-						break;
-					}
-				}
-			}
+		const bool bHostile = bWeighted && ActorMetadataCache::GetSingleton()->Get(a_candidate.actor.get()).bHostileToPlayer;
+		_targetScoringBatch.Add(a_candidate.targetPosition, a_candidate.maxDistance, bHostile, a_candidate.handle.native_handle());
+		_targetScoringCandidates.push_back(std::addressof(a_candidate));
+	});
+
+	const TargetScoringBatch::Weights weights{ Settings::fTargetLockWeightDistance, Settings::fTargetLockWeightAngle, Settings::fTargetLockWeightHostility };
+	_targetScoringBatch.Score(playerPosition, cameraForwardVector, static_cast<TargetScoringBatch::Mode>(a_mode), weights);
+	_targetScoringBatch.GetRanking(_targetScoringRanking);
+
+	// line of sight is the expensive part, so test the candidates best first and stop at the first one in sight
+	for (auto index : _targetScoringRanking) {
+		auto candidate = _targetScoringCandidates[index];
+		if (HasLineOfSightToTarget(candidate->actor.get(), true)) {
+			return candidate->handle;
 		}
 	}
 
-	return bestTarget;
+	return RE::ActorHandle();
 }
 
 void DirectionalMovementHandler::SwitchTarget(Direction a_direction)
@@ -1799,6 +2107,20 @@ bool DirectionalMovementHandler::SwitchTargetPoint(Direction a_direction)
 		return false;
 	}
 
+	UpdateTargetSwitchGraphs();
+	if (_bTargetSwitchGraphsValid) {
+		auto it = std::find(_targetPointSwitchGraphPoints.begin(), _targetPointSwitchGraphPoints.end(), _currentTargetPoint);
+		if (it != _targetPointSwitchGraphPoints.end()) {
+			auto neighbor = _targetPointSwitchGraph.FindNeighbor(static_cast<std::uint32_t>(it - _targetPointSwitchGraphPoints.begin()), ToScreenDirection(a_direction));
+			if (neighbor == ScreenNeighborGraph::kInvalid) {
+				return false;
+			}
+
+			_currentTargetPoint = _targetPointSwitchGraphPoints[neighbor];
+			return true;
+		}
+	}
+
 	RE::NiPoint3 currentTargetPos = _currentTargetPoint->world.translate;
 
 	float bestScreenDistance = FLT_MAX;
@@ -1809,6 +2131,10 @@ bool DirectionalMovementHandler::SwitchTargetPoint(Direction a_direction)
 	constexpr RE::NiPoint2 leftVector{ -1.f, 0.f };
 	constexpr RE::NiPoint2 rightVector{ 1.f, 0.f };
 
+	RE::NiPoint2 currentTargetScreenPosition;
+	float currentTargetDepth;
+	_frameContext.WorldPtToScreenPt3(currentTargetPos, currentTargetScreenPosition, currentTargetDepth);
+
 	for (auto& targetPoint : targetPoints) {
 		if (!targetPoint || targetPoint == _currentTargetPoint) {
 			continue;
@@ -1816,12 +2142,9 @@ bool DirectionalMovementHandler::SwitchTargetPoint(Direction a_direction)
 
 		RE::NiPoint3 newTargetPos = targetPoint->world.translate;
 
-		RE::NiPoint2 currentTargetScreenPosition;
-		float currentTargetDepth;
 		RE::NiPoint2 newTargetScreenPosition;
 		float newTargetDepth;
-		RE::NiCamera::WorldPtToScreenPt3((float(*)[4])g_worldToCamMatrix, *g_viewPort, currentTargetPos, currentTargetScreenPosition.x, currentTargetScreenPosition.y, currentTargetDepth, 1e-5f);
-		RE::NiCamera::WorldPtToScreenPt3((float(*)[4])g_worldToCamMatrix, *g_viewPort, newTargetPos, newTargetScreenPosition.x, newTargetScreenPosition.y, newTargetDepth, 1e-5f);
+		_frameContext.WorldPtToScreenPt3(newTargetPos, newTargetScreenPosition, newTargetDepth);
 
 		if (newTargetDepth < 0.f) {  // offscreen
 			continue;
@@ -1872,16 +2195,32 @@ RE::ActorHandle DirectionalMovementHandler::SwitchScreenTarget(Direction a_direc
 {
 	RE::ActorHandle newTarget;
 
-	auto& actorHandles = RE::ProcessLists::GetSingleton()->highActorHandles;
-	if (actorHandles.size() == 0) {
+	UpdateTargetSwitchGraphs();
+	if (_bTargetSwitchGraphsValid) {
+		auto it = _targetSwitchGraphIndices.find(_target);
+		if (it != _targetSwitchGraphIndices.end()) {
+			auto neighbor = _targetSwitchGraph.FindNeighbor(it->second, ToScreenDirection(a_direction));
+			if (neighbor == ScreenNeighborGraph::kInvalid) {
+				return newTarget;
+			}
+
+			auto& neighborHandle = _targetSwitchGraphActors[neighbor];
+			if (auto neighborActor = neighborHandle.get(); neighborActor && HasLineOfSightToTarget(neighborActor.get(), true)) {
+				return neighborHandle;
+			}
+			// the best neighbor is out of sight, fall back to scanning for the next best one
+		}
+	}
+
+	auto& targetCandidates = GetTargetCandidates();
+	if (targetCandidates.IsEmpty()) {
 		return newTarget;
 	}
 
-	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
-	RE::NiPoint3 playerPosition;
-	if (!GetTorsoPos(playerCharacter, playerPosition)) {
+	if (!_frameContext.bHasTorsoPosition) {
 		return newTarget;
 	}
+	const RE::NiPoint3 playerPosition = _frameContext.torsoPosition;
 
 	const RE::NiPoint3 currentTargetPosition = GetTargetPosition();
 
@@ -1892,68 +2231,67 @@ RE::ActorHandle DirectionalMovementHandler::SwitchScreenTarget(Direction a_direc
 	constexpr RE::NiPoint2 leftVector{ -1.f, 0.f };
 	constexpr RE::NiPoint2 rightVector{ 1.f, 0.f };
 
-	for (auto& actorHandle : actorHandles) {
-		if (actorHandle == _target) {
-			continue;
+	RE::NiPoint2 currentTargetScreenPosition;
+	float currentTargetDepth;
+	_frameContext.WorldPtToScreenPt3(currentTargetPosition, currentTargetScreenPosition, currentTargetDepth);
+
+	targetCandidates.ForEachInRadius(playerPosition, targetCandidates.GetMaxDistance() + targetPointQuerySlack, [&](TargetCandidate& a_candidate) {
+		if (a_candidate.handle == _target) {
+			return;
 		}
 
-		auto actor = actorHandle.get();
-		if (IsActorValidTarget(actor)) {
-			auto actorTargetPoint = GetBestTargetPoint(actorHandle);
-
-			float targetLockMaxDistance = Settings::fTargetLockDistance * GetTargetLockDistanceRaceSizeMultiplier(actor->GetRace());
-			RE::NiPoint3 newTargetPosition = actorTargetPoint ? actorTargetPoint->world.translate : actor->GetLookingAtLocation();
-			float distance = playerPosition.GetDistance(newTargetPosition);
-
-			if (distance <= targetLockMaxDistance) {
-				RE::NiPoint2 currentTargetScreenPosition;
-				float currentTargetDepth;
-				RE::NiPoint2 newTargetScreenPosition;
-				float newTargetDepth;
-				RE::NiCamera::WorldPtToScreenPt3((float(*)[4])g_worldToCamMatrix, *g_viewPort, currentTargetPosition, currentTargetScreenPosition.x, currentTargetScreenPosition.y, currentTargetDepth, 1e-5f);
-				RE::NiCamera::WorldPtToScreenPt3((float(*)[4])g_worldToCamMatrix, *g_viewPort, newTargetPosition, newTargetScreenPosition.x, newTargetScreenPosition.y, newTargetDepth, 1e-5f);
-
-				if (newTargetDepth < 0.f) {  // offscreen
-					continue;
-				}
+		ResolveTargetPoint(a_candidate);
 
-				bool bIsCorrectDirection = false;
-				RE::NiPoint2 directionVector;
+		const RE::NiPoint3& newTargetPosition = a_candidate.targetPosition;
+		float distance = playerPosition.GetDistance(newTargetPosition);
 
-				switch (a_direction) {
-				case Direction::kLeft:
-					bIsCorrectDirection = newTargetScreenPosition.x < currentTargetScreenPosition.x;
-					directionVector = leftVector;
-					break;
-				case Direction::kRight:
-					bIsCorrectDirection = newTargetScreenPosition.x > currentTargetScreenPosition.x;
-					directionVector = rightVector;
-					break;
-				case Direction::kForward:
-				case Direction::kUp:
-					bIsCorrectDirection = newTargetScreenPosition.y > currentTargetScreenPosition.y;
-					directionVector = upVector;
-					break;
-				case Direction::kBack:
-				case Direction::kDown:
-					bIsCorrectDirection = newTargetScreenPosition.y < currentTargetScreenPosition.y;
-					directionVector = downVector;
-					break;
-				}
+		if (distance > a_candidate.maxDistance) {
+			return;
+		}
 
-				if (bIsCorrectDirection) {
-					RE::NiPoint2 distanceVector = newTargetScreenPosition - currentTargetScreenPosition;
-					float screenDistance = distanceVector.Unitize();
-					float directionMult = 2.f - directionVector.Dot(distanceVector); // so targets that are closer to the desired direction are given better score than closer targets that aren't really in that direction
+		RE::NiPoint2 newTargetScreenPosition;
+		float newTargetDepth;
+		_frameContext.WorldPtToScreenPt3(newTargetPosition, newTargetScreenPosition, newTargetDepth);
 
-					if (screenDistance * directionMult < bestScreenDistance) {
-						bestScreenDistance = screenDistance;
-						newTarget = actorHandle;
-					}
-				}
+		if (newTargetDepth < 0.f) {  // offscreen
+			return;
+		}
+
+		bool bIsCorrectDirection = false;
+		RE::NiPoint2 directionVector;
+
+		switch (a_direction) {
+		case Direction::kLeft:
+			bIsCorrectDirection = newTargetScreenPosition.x < currentTargetScreenPosition.x;
+			directionVector = leftVector;
+			break;
+		case Direction::kRight:
+			bIsCorrectDirection = newTargetScreenPosition.x > currentTargetScreenPosition.x;
+			directionVector = rightVector;
+			break;
+		case Direction::kForward:
+		case Direction::kUp:
+			bIsCorrectDirection = newTargetScreenPosition.y > currentTargetScreenPosition.y;
+			directionVector = upVector;
+			break;
+		case Direction::kBack:
+		case Direction::kDown:
+			bIsCorrectDirection = newTargetScreenPosition.y < currentTargetScreenPosition.y;
+			directionVector = downVector;
+			break;
+		}
+
+		if (bIsCorrectDirection) {
+			RE::NiPoint2 distanceVector = newTargetScreenPosition - currentTargetScreenPosition;
+			float screenDistance = distanceVector.Unitize();
+			float directionMult = 2.f - directionVector.Dot(distanceVector); // so targets that are closer to the desired direction are given better score than closer targets that aren't really in that direction
+
+			if (screenDistance * directionMult < bestScreenDistance && HasLineOfSightToTarget(a_candidate.actor.get(), true)) {
+				bestScreenDistance = screenDistance;
+				newTarget = a_candidate.handle;
 			}
 		}
-	}
+	});
 
 	return newTarget;
 }
@@ -1971,12 +2309,7 @@ std::vector<RE::NiPointer<RE::NiAVObject>> DirectionalMovementHandler::GetTarget
 		return ret;
 	}
 
-	auto race = actor->GetRace();
-	if (!race) {
-		return ret;
-	}
-
-	RE::BGSBodyPartData* bodyPartData = race->bodyPartData;
+	RE::BGSBodyPartData* bodyPartData = ActorMetadataCache::GetSingleton()->Get(actor).bodyPartData;
 	if (!bodyPartData) {
 		return ret;
 	}
@@ -1986,11 +2319,9 @@ std::vector<RE::NiPointer<RE::NiAVObject>> DirectionalMovementHandler::GetTarget
 		return ret;
 	}
 
-	auto it = Settings::targetPoints.find(bodyPartData);
-	if (it != Settings::targetPoints.end()) {
-		auto& targetPoints = it->second;
-		for (auto& targetPoint : targetPoints) {
-			auto node = NiAVObject_LookupBoneNodeByName(actor3D, targetPoint, true);
+	if (auto targetPoints = Settings::GetTargetPoints(bodyPartData)) {
+		for (auto& targetPoint : *targetPoints) {
+			auto node = BoneCache::GetSingleton()->LookupBoneNode(actor3D, targetPoint);
 			if (node) {
 				ret.push_back(RE::NiPointer<RE::NiAVObject>(node));
 			}
@@ -2004,7 +2335,7 @@ std::vector<RE::NiPointer<RE::NiAVObject>> DirectionalMovementHandler::GetTarget
 		return ret;
 	}
 
-	auto node = NiAVObject_LookupBoneNodeByName(actor3D, bodyPart->targetName, true);
+	auto node = BoneCache::GetSingleton()->LookupBoneNode(actor3D, bodyPart->targetName);
 	ret.push_back(RE::NiPointer<RE::NiAVObject>(node));
 	return ret;
 }
@@ -2050,16 +2381,16 @@ bool DirectionalMovementHandler::SetDesiredAngleToMagnetismTarget()
 		return false;
 	}
 
-	auto& actorHandles = RE::ProcessLists::GetSingleton()->highActorHandles;
-	if (actorHandles.size() == 0) {
-		_bMagnetismActive = false;
-		return false;
-	}
-
 	if (_bMagnetismActive) {
 		return true;
 	}
 
+	auto& targetCandidates = GetTargetCandidates();
+	if (targetCandidates.IsEmpty()) {
+		_bMagnetismActive = false;
+		return false;
+	}
+
 	bool bFoundMagnetismTarget = false;
 	float magnetismAngleDelta = (Settings::fMeleeMagnetismAngle * PI) / 180.f;
 	float smallestDistance = _meleeMagnetismRange;
@@ -2071,33 +2402,33 @@ bool DirectionalMovementHandler::SetDesiredAngleToMagnetismTarget()
 		desiredAngle = playerCharacter->data.angle.z;
 	}
 
-	for (auto& actorHandle : actorHandles) {
-		auto actor = actorHandle.get();
-		if (IsActorValidTarget(actor)) {
-			auto actorPosition = actor->GetPosition();
-			auto distance = actorPosition.GetDistance(playerPosition);
-			if (distance < _meleeMagnetismRange)
+	RE::NiPoint2 forwardVector(0.f, 1.f);
+	RE::NiPoint2 desiredDirection = Vec2Rotate(forwardVector, desiredAngle);
+	RE::NiPoint2 desiredWorldDirection(-desiredDirection.x, desiredDirection.y);  // angles here are measured with a mirrored x axis
+
+	RE::ActorHandle magnetismTarget;
+	targetCandidates.ForEachInCone(playerPosition, desiredWorldDirection, _meleeMagnetismRange, fabs(magnetismAngleDelta), [&](TargetCandidate& a_candidate) {
+		auto& actorPosition = a_candidate.position;
+		auto distance = actorPosition.GetDistance(playerPosition);
+		if (distance < _meleeMagnetismRange)
+		{
+			RE::NiPoint2 directionToTarget = RE::NiPoint2(-(actorPosition.x - playerPosition.x), actorPosition.y - playerPosition.y);
+			directionToTarget.Unitize();
+
+			float angleDelta = NormalRelativeAngle(GetAngle(desiredDirection, directionToTarget));
+			//if (GetAngleDiff(angleDelta, magnetismAngleDelta) < fabs(magnetismAngleDelta) || GetAngleDiff(angleDelta, -magnetismAngleDelta) < fabs(magnetismAngleDelta))
+			if (fabs(angleDelta) < fabs(magnetismAngleDelta) && distance < smallestDistance && HasLineOfSightToTarget(a_candidate.actor.get()))
 			{
-				RE::NiPoint2 directionToTarget = RE::NiPoint2(-(actorPosition.x - playerPosition.x), actorPosition.y - playerPosition.y);
-				directionToTarget.Unitize();
-
-				RE::NiPoint2 forwardVector(0.f, 1.f);
-				RE::NiPoint2 desiredDirection = Vec2Rotate(forwardVector, desiredAngle);
-
-				float angleDelta = NormalRelativeAngle(GetAngle(desiredDirection, directionToTarget));
-				//if (GetAngleDiff(angleDelta, magnetismAngleDelta) < fabs(magnetismAngleDelta) || GetAngleDiff(angleDelta, -magnetismAngleDelta) < fabs(magnetismAngleDelta))
-				if (fabs(angleDelta) < fabs(magnetismAngleDelta) && distance < smallestDistance)
-				{
-					smallestDistance = distance;
-					magnetismAngleDelta = angleDelta;
-					bFoundMagnetismTarget = true;
-					SetSoftTarget(actorHandle);
-				}
+				smallestDistance = distance;
+				magnetismAngleDelta = angleDelta;
+				bFoundMagnetismTarget = true;
+				magnetismTarget = a_candidate.handle;
 			}
 		}
-	}
+	});
 
 	if (bFoundMagnetismTarget) {
+		SetSoftTarget(magnetismTarget);
 		_desiredAngle = NormalAbsoluteAngle(desiredAngle + magnetismAngleDelta);
 		_bMagnetismActive = true;
 		return true;
@@ -2124,6 +2455,7 @@ void DirectionalMovementHandler::SetTarget(RE::ActorHandle a_target)
 	}
 
 	_target = a_target;
+	_targetVelocityEstimator.Reset();  // locking the same actor again later must not pick up where the last lock left off
 
 	SetTargetPoint(GetBestTargetPoint(a_target));
 
@@ -2176,22 +2508,119 @@ void DirectionalMovementHandler::SetTargetPoint(RE::NiPointer<RE::NiAVObject> a_
 
 RE::NiAVObject* DirectionalMovementHandler::GetProjectileTargetPoint(RE::ObjectRefHandle a_projectileHandle) const
 {
-	auto it = _projectileTargets.find(a_projectileHandle);
-	if (it != _projectileTargets.end() && it->second) {
-		return it->second.get();
-	}
-
-	return nullptr;
+	return _projectileTargets.Find(a_projectileHandle);
 }
 
 void DirectionalMovementHandler::AddProjectileTarget(RE::ObjectRefHandle a_projectileHandle, RE::NiPointer<RE::NiAVObject> a_targetPoint)
 {
-	_projectileTargets.emplace(a_projectileHandle, a_targetPoint);
+	_projectileTargets.Insert(a_projectileHandle, std::move(a_targetPoint));
 }
 
 void DirectionalMovementHandler::RemoveProjectileTarget(RE::ObjectRefHandle a_projectileHandle)
 {
-	_projectileTargets.erase(a_projectileHandle);
+	_projectileTargets.Erase(a_projectileHandle);
+}
+
+TargetLockProjectileAimType DirectionalMovementHandler::GetProjectileAimType(RE::Projectile* a_projectile)
+{
+	switch (a_projectile->formType.get()) {
+	case RE::FormType::ProjectileArrow:
+		return Settings::uTargetLockArrowAimType;
+	case RE::FormType::ProjectileMissile:
+		return Settings::uTargetLockMissileAimType;
+	default:
+		return TargetLockProjectileAimType::kFreeAim;
+	}
+}
+
+void DirectionalMovementHandler::ApplyProjectileGuidance(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode)
+{
+	auto projectileHandle = a_projectile->GetHandle();
+
+	if (Settings::bTargetLockBatchedProjectileGuidance) {
+		// the first projectile updated this frame steers all of them
+		if (_projectileGuidanceFrame != _frameCount) {
+			UpdateProjectileGuidance();
+		}
+
+		auto guidance = _projectileTargets.FindGuidance(projectileHandle);
+		if (guidance && guidance->frame == _frameCount) {
+			guidance->Apply(a_projectile, a_projectileNode);
+			return;
+		}
+	}
+
+	// not batched, or fired after this frame's batch ran
+	if (auto targetPoint = _projectileTargets.Find(projectileHandle)) {
+		ProjectileGuidance guidance;
+		guidance.Compute(a_projectile->data.location, targetPoint->world.translate);
+		guidance.Apply(a_projectile, a_projectileNode);
+	}
+}
+
+bool DirectionalMovementHandler::GetTargetVelocity(RE::ActorHandle a_target, RE::NiPoint3& a_outVelocity) const
+{
+	if (_targetVelocityEstimator.GetVelocity(a_target, a_outVelocity)) {
+		return true;
+	}
+
+	// not tracked long enough yet, fall back to the instantaneous velocity
+	if (auto target = a_target.get()) {
+		target->GetLinearVelocity(a_outVelocity);
+		return true;
+	}
+
+	return false;
+}
+
+void DirectionalMovementHandler::PredictProjectileVelocity(const RE::NiPoint3& a_origin, RE::ActorHandle a_target, const RE::NiPoint3& a_targetPosition, const RE::NiPoint3& a_targetVelocity, float a_gravity, RE::NiPoint3& a_projectileVelocity)
+{
+	const bool bIterative = Settings::uTargetLockPredictionSolver == ProjectilePredictionSolver::kIterative;
+	const bool bShareable = !bIterative || Settings::fTargetLockProjectileDrag <= FLT_EPSILON;  // the shared solution is rebuilt without drag
+	const float speed = a_projectileVelocity.Length();
+
+	auto& shared = _sharedAimPrediction;
+	if (bShareable && shared.frame == _frameCount && shared.target == a_target && ApproximatelyEqual(shared.gravity, a_gravity) &&
+		std::fabs(shared.speed - speed) <= _sharedAimPredictionSpeedTolerance && shared.origin.GetDistance(a_origin) <= _sharedAimPredictionOriginTolerance) {
+		// same time of flight, exact aim from this projectile's own origin
+		a_projectileVelocity = (shared.aimPoint - a_origin) / shared.flightTime;
+		if (!ApproximatelyEqual(a_gravity, 0.f)) {
+			a_projectileVelocity.z += 0.5f * a_gravity * shared.flightTime;
+		}
+		Profiler::Count(Profiler::Counter::kAimPredictionReused);
+		return;
+	}
+
+	Profiler::Count(Profiler::Counter::kAimPredictionSolved);
+
+	float flightTime = 0.f;
+	const bool bValidSolution = bIterative ?
+		PredictAimProjectileIterative(a_origin, a_targetPosition, a_targetVelocity, a_gravity, Settings::fTargetLockProjectileDrag, a_projectileVelocity, &flightTime) :
+		PredictAimProjectile(a_origin, a_targetPosition, a_targetVelocity, a_gravity, a_projectileVelocity, &flightTime);
+
+	if (bShareable && bValidSolution && flightTime > 0.f) {
+		shared.frame = _frameCount;
+		shared.target = a_target;
+		shared.origin = a_origin;
+		shared.aimPoint = a_targetPosition + a_targetVelocity * flightTime;
+		shared.speed = speed;
+		shared.gravity = a_gravity;
+		shared.flightTime = flightTime;
+	} else {
+		shared.frame = SharedAimPrediction::invalidFrame;
+	}
+}
+
+void DirectionalMovementHandler::ApplyProjectileNavigation(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode)
+{
+	RE::NiAVObject* targetPoint = nullptr;
+	auto guidance = _projectileTargets.FindGuidance(a_projectile->GetHandle(), &targetPoint);
+	if (guidance && targetPoint) {
+		// the turn rate cap is integrated over the step the projectile itself moves with, so this reads the game's delta time in the projectile's
+		// update. Homing turns all the way at once and its batch only needs the frame number. The frame context's delta time is scaled by the
+		// player's time multiplier and taken in Update, which may run after the projectiles this frame.
+		guidance->Navigate(a_projectile, a_projectileNode, targetPoint->world.translate, *g_deltaTime, Settings::fTargetLockNavigationConstant, AngleToRadian(Settings::fTargetLockNavigationMaxTurnRate));
+	}
 }
 
 void DirectionalMovementHandler::AddTargetLockReticle(RE::ActorHandle a_target, RE::NiPointer<RE::NiAVObject> a_targetPoint)
@@ -2496,48 +2925,47 @@ void DirectionalMovementHandler::LookAtTarget(RE::ActorHandle a_target)
 		return;
 	}
 
-	RE::NiPoint3 playerPos;
-	if (!GetTorsoPos(playerCharacter, playerPos)) {
+	if (!_frameContext.bHasTorsoPosition) {
 		return;
 	}
+	const RE::NiPoint3 playerPos = _frameContext.torsoPosition;
 
 	float currentCharacterYaw = playerCharacter->data.angle.z;
 	float currentCharacterPitch = playerCharacter->data.angle.x;
 	float currentCameraYawOffset = NormalAbsoluteAngle(thirdPersonState->freeRotation.x);
 
-	RE::NiPoint3 cameraPos = GetCameraPos();
+	const RE::NiPoint3 cameraPos = _frameContext.cameraPosition;
 
 	//RE::NiPoint3 midPoint = (playerPos + targetPos) / 2;
 
-	float distanceToTarget = playerPos.GetDistance(targetPos);
+	const auto targetVector = VectorMath::Load(targetPos);
+	const auto playerVector = VectorMath::Load(playerPos);
+	const auto cameraVector = VectorMath::Load(cameraPos);
+
+	const auto playerToTarget = VectorMath::Subtract(targetVector, playerVector);
+	float distanceToTarget;
+	const RE::NiPoint3 playerDirectionToTarget = VectorMath::ToNiPoint3(VectorMath::Normalize(playerToTarget, &distanceToTarget));
 	float zOffset = distanceToTarget * Settings::fTargetLockPitchOffsetStrength;
 
 	if (bIsHorseCamera) {
 		zOffset *= -1.f;
 	}
 
-	RE::NiPoint3 offsetTargetPos = targetPos;
-	offsetTargetPos.z -= zOffset;
+	const auto offsetTargetVector = VectorMath::Subtract(targetVector, VectorMath::Set(0.f, 0.f, zOffset));
 	//offsetTargetPos = midPoint;
 
-	RE::NiPoint3 playerToTarget = RE::NiPoint3(targetPos.x - playerPos.x, targetPos.y - playerPos.y, targetPos.z - playerPos.z);
-	RE::NiPoint3 playerDirectionToTarget = playerToTarget;
-	playerDirectionToTarget.Unitize();
-	RE::NiPoint3 cameraToTarget = RE::NiPoint3(offsetTargetPos.x - cameraPos.x, offsetTargetPos.y - cameraPos.y, offsetTargetPos.z - cameraPos.z);
-	RE::NiPoint3 cameraDirectionToTarget = cameraToTarget;
-	cameraDirectionToTarget.Unitize();
-	RE::NiPoint3 cameraToPlayer = RE::NiPoint3(playerPos.x - cameraPos.x, playerPos.y - cameraPos.y, playerPos.z - cameraPos.z);
+	const auto cameraToTarget = VectorMath::Subtract(offsetTargetVector, cameraVector);
+	const RE::NiPoint3 cameraDirectionToTarget = VectorMath::ToNiPoint3(VectorMath::Normalize(cameraToTarget));
+	const auto cameraToPlayer = VectorMath::Subtract(playerVector, cameraVector);
 
-	RE::NiPoint3 projected = Project(cameraToPlayer, cameraToTarget);
-	RE::NiPoint3 projectedPos = RE::NiPoint3(projected.x + cameraPos.x, projected.y + cameraPos.y, projected.z + cameraPos.z);
-	RE::NiPoint3 projectedDirectionToTarget = RE::NiPoint3(targetPos.x - projectedPos.x, targetPos.y - projectedPos.y, targetPos.z - projectedPos.z);
-	projectedDirectionToTarget.Unitize();
+	const auto projectedPos = VectorMath::Add(VectorMath::Project(cameraToPlayer, cameraToTarget), cameraVector);
+	const auto projectedDirectionToTarget = VectorMath::Normalize(VectorMath::Subtract(targetVector, projectedPos));
 
 	// yaw
 	RE::NiPoint2 forwardVector(0.f, 1.f);
 	RE::NiPoint2 currentCameraDirection = Vec2Rotate(forwardVector, currentCharacterYaw + currentCameraYawOffset);
 
-	RE::NiPoint2 projectedDirectionToTargetXY(-projectedDirectionToTarget.x, projectedDirectionToTarget.y);
+	RE::NiPoint2 projectedDirectionToTargetXY(-VectorMath::GetX(projectedDirectionToTarget), VectorMath::GetY(projectedDirectionToTarget));
 
 	bool bIsBehind = projectedDirectionToTargetXY.Dot(currentCameraDirection) < 0;
 
@@ -2545,7 +2973,7 @@ void DirectionalMovementHandler::LookAtTarget(RE::ActorHandle a_target)
 	float angleDelta = bIsBehind ? GetAngle(reversedCameraDirection, projectedDirectionToTargetXY) : GetAngle(currentCameraDirection, projectedDirectionToTargetXY);
 	angleDelta = NormalRelativeAngle(angleDelta);
 
-	const float realTimeDeltaTime = GetRealTimeDeltaTime();
+	const float realTimeDeltaTime = _frameContext.realTimeDeltaTime;
 
 	float desiredFreeCameraRotation = currentCameraYawOffset + angleDelta;
 	thirdPersonState->freeRotation.x = InterpAngleTo(currentCameraYawOffset, desiredFreeCameraRotation, realTimeDeltaTime, Settings::fTargetLockYawAdjustSpeed);
@@ -2682,10 +3110,28 @@ void DirectionalMovementHandler::OnPreLoadGame()
 	_playerIsNPC = false;
 	_papyrusDisableDirectionalMovement.clear();
 	_papyrusDisableHeadtracking.clear();
+	_targetCandidates.Clear();
+	_bTargetCandidatesValid = false;
+	{
+		TargetValidityLocker locker(_targetValidityLock);
+		_targetValidityCache.clear();
+		_lineOfSightScheduler.Clear();
+	}
+	{
+		Locker locker(_leaningLock);
+		_leaningLODScheduler.Clear();
+	}
+	_projectileTargets.Clear();
+	_targetVelocityEstimator.Reset();
+	BoneCache::GetSingleton()->Clear();
+	ActorMetadataCache::GetSingleton()->Clear();
+	GraphVariableCache::GetSingleton()->Clear();
 }
 
 void DirectionalMovementHandler::OnSettingsUpdated()
 {
+	ActorMetadataCache::GetSingleton()->Clear();  // the race size distance multipliers may have changed
+
 	if (!Settings::bHeadtracking) {
 		auto playerCharacter = RE::PlayerCharacter::GetSingleton();
 		if (playerCharacter) {
@@ -2788,6 +3234,11 @@ bool DirectionalMovementHandler::IsBehaviorPatchInstalled(RE::TESObjectREFR* a_r
 		return false;
 	}
 
+	if (auto actor = a_ref->As<RE::Actor>()) {
+		GraphVariableCache::Variables graphVariables;
+		return GraphVariableCache::GetSingleton()->Get(actor, graphVariables) && graphVariables.Has(GraphVariableCache::Variable::kHeadtrackingSKSE);
+	}
+
 	bool bOut;
 	return a_ref->GetGraphVariableBool("tdmHeadtrackingSKSE", bOut);
 }
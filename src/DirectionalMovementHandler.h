@@ -1,5 +1,14 @@
 #pragma once
+#include "FrameContext.h"
+#include "LeaningBatch.h"
+#include "LeaningLODScheduler.h"
+#include "LineOfSightScheduler.h"
+#include "ProjectileTargetTable.h"
+#include "ScreenNeighborGraph.h"
 #include "SmoothCamAPI.h"
+#include "TargetCandidateIndex.h"
+#include "TargetScoring.h"
+#include "TargetVelocityEstimator.h"
 #include "TrueHUDAPI.h"
 #include "Widgets/TargetLockReticle.h"
 #include <unordered_set>
@@ -50,6 +59,7 @@ public:
 	static void ResetControls();
 
 	void Update();
+	void FinishActorUpdates();  // solves the leaning batch and flushes the graph variable writes the frame's actor updates queued
 	void UpdateDirectionalMovement();
 	void UpdateFacingState();
 	void UpdateFacingCrosshair();
@@ -60,6 +70,7 @@ public:
 	void ProgressTimers();
 	
 	void UpdateProjectileTargetMap();
+	void UpdateProjectileGuidance();
 
 	void UpdateLeaning(RE::Actor* a_actor, float a_deltaTime);
 
@@ -124,7 +135,8 @@ public:
 	{
 		kClosest = 0,
 		kCenter = 1,
-		kCombined = 2
+		kCombined = 2,
+		kWeighted = 3
 	};
 
 	SKSE::stl::enumeration<Direction, std::uint8_t> _pressedDirections;
@@ -140,8 +152,15 @@ public:
 	float GetTargetLockDistanceRaceSizeMultiplier(RE::TESRace* a_race) const;
 	bool CheckCurrentTarget(RE::ActorHandle a_target, bool bInstantLOS = false);
 	void UpdateTargetLock();
+	void UpdateTargetSwitchGraphs();
 
 	bool IsActorValidTarget(RE::ActorPtr a_actor, bool a_bCheckDistance = false) const;
+	bool IsActorValidTargetCandidate(RE::ActorPtr a_actor) const;
+	// a priority test runs regardless of the line of sight budget, use it for anything the player is waiting on. Otherwise a test over
+	// budget answers with the last known result and is refreshed on a later frame
+	bool HasLineOfSightToTarget(RE::Actor* a_actor, bool a_bPriority = false) const;
+	// called from the event sinks when a_refr may have become or stopped being a candidate
+	void InvalidateTargetCandidate(RE::TESObjectREFR* a_refr);
 
 	RE::ActorHandle FindTarget(TargetLockSelectionMode a_mode, bool a_bSkipCurrent = true);
 	void SwitchTarget(Direction a_direction);
@@ -162,6 +181,11 @@ public:
 	RE::NiAVObject* GetProjectileTargetPoint(RE::ObjectRefHandle a_projectileHandle) const;
 	void AddProjectileTarget(RE::ObjectRefHandle a_projectileHandle, RE::NiPointer<RE::NiAVObject> a_targetPoint);
 	void RemoveProjectileTarget(RE::ObjectRefHandle a_projectileHandle);
+	static TargetLockProjectileAimType GetProjectileAimType(RE::Projectile* a_projectile);
+	void ApplyProjectileGuidance(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode);
+	void ApplyProjectileNavigation(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode);
+	bool GetTargetVelocity(RE::ActorHandle a_target, RE::NiPoint3& a_outVelocity) const;
+	void PredictProjectileVelocity(const RE::NiPoint3& a_origin, RE::ActorHandle a_target, const RE::NiPoint3& a_targetPosition, const RE::NiPoint3& a_targetVelocity, float a_gravity, RE::NiPoint3& a_projectileVelocity);
 
 	void AddTargetLockReticle(RE::ActorHandle a_target, RE::NiPointer<RE::NiAVObject> a_targetPoint);
 	void ReticleRemoved();
@@ -233,6 +257,8 @@ public:
 	void PapyrusDisableDirectionalMovement(std::string_view a_modName, bool a_bDisable);
 	void PapyrusDisableHeadtracking(std::string_view a_modName, bool a_bDisable);
 
+	const FrameContext& GetFrameContext() const { return _frameContext; }
+
 	bool IsACCInstalled() const { return _bACCInstalled; }
 	bool IsICInstalled() const { return _bICInstalled; }
 
@@ -248,8 +274,29 @@ private:
 	DirectionalMovementHandler& operator=(const DirectionalMovementHandler&) = delete;
 	DirectionalMovementHandler& operator=(DirectionalMovementHandler&&) = delete;
 
+	// validity sub-results of a target, valid for the frame they were resolved in
+	struct TargetValidity
+	{
+		std::uint32_t frame = 0;
+		bool bCandidateResolved = false;
+		bool bCandidate = false;
+		bool bLineOfSightResolved = false;
+		bool bLineOfSight = false;
+	};
+
+	TargetCandidateIndex& GetTargetCandidates();
+	void ResolveTargetPoint(TargetCandidate& a_candidate) const;
+	bool CheckTargetCandidate(RE::ActorPtr a_actor) const;
+	TargetValidity& GetTargetValidity(RE::Actor* a_actor) const;  // _targetValidityLock must be held while the entry is used
+	void PruneTargetValidityCache();
+	void SolveLeaning();
+	static LeaningLODScheduler::Level GetLeaningLODLevel(RE::Actor* a_actor, const FrameContext& a_frameContext);
+
 	mutable Lock _lock;
 
+	std::uint32_t _frameCount = 0;
+	FrameContext _frameContext;
+
 	float _defaultControllerBufferDepth = -1.f;
 	float _defaultAcrobatics = -1.f;
 	
@@ -332,7 +379,67 @@ private:
 	RE::ObjectRefHandle _dialogueSpeaker;
 	RE::NiPointer<RE::NiAVObject> _currentTargetPoint;
 	
-	std::unordered_map<RE::ObjectRefHandle, RE::NiPointer<RE::NiAVObject>> _projectileTargets;
+	ProjectileTargetTable _projectileTargets;
+	std::uint32_t _projectileGuidanceFrame = ProjectileGuidance::invalidFrame;
+
+	TargetVelocityEstimator _targetVelocityEstimator;
+
+	// the last aim prediction solved this frame, reused by projectiles spawned alongside it (multishot, spread spells)
+	struct SharedAimPrediction
+	{
+		static constexpr std::uint32_t invalidFrame = std::numeric_limits<std::uint32_t>::max();
+
+		std::uint32_t frame = invalidFrame;
+		RE::ActorHandle target;
+		RE::NiPoint3 origin;
+		RE::NiPoint3 aimPoint;  // target position at impact
+		float speed = 0.f;
+		float gravity = 0.f;
+		float flightTime = 0.f;
+	};
+	SharedAimPrediction _sharedAimPrediction;
+	static constexpr float _sharedAimPredictionOriginTolerance = 64.f;
+	static constexpr float _sharedAimPredictionSpeedTolerance = 1.f;
+
+	TargetCandidateIndex _targetCandidates;
+	std::uint32_t _targetCandidatesFrame = 0;
+	std::atomic_bool _bTargetCandidatesValid{ false };  // cleared from the event sinks
+
+	// the validity checks are public and reached from hooks as well as the main update, so the cache and the line of sight scheduler
+	// are only touched under _targetValidityLock
+	using TargetValidityLock = std::mutex;
+	using TargetValidityLocker = std::lock_guard<TargetValidityLock>;
+	mutable TargetValidityLock _targetValidityLock;
+	mutable std::unordered_map<RE::ActorHandle, TargetValidity> _targetValidityCache;
+	mutable LineOfSightScheduler _lineOfSightScheduler;
+
+	// the lock-on candidates and the locked target's target points on screen, gathered on a switch input
+	ScreenNeighborGraph _targetSwitchGraph;
+	std::vector<RE::ActorHandle> _targetSwitchGraphActors;
+	std::unordered_map<RE::ActorHandle, std::uint32_t> _targetSwitchGraphIndices;
+	std::vector<RE::ActorHandle> _targetSwitchGraphCandidates;
+	std::vector<RE::NiPoint3> _targetSwitchGraphPositions;
+	std::vector<RE::NiPoint2> _targetSwitchGraphScreenPositions;
+	std::vector<float> _targetSwitchGraphDepths;
+	ScreenNeighborGraph _targetPointSwitchGraph;
+	std::vector<RE::NiPointer<RE::NiAVObject>> _targetPointSwitchGraphPoints;
+	RE::ActorHandle _targetSwitchGraphTarget;
+	std::uint32_t _targetSwitchGraphFrame = 0;
+	bool _bTargetSwitchGraphsValid = false;
+
+	TargetScoringBatch _targetScoringBatch;
+	std::vector<TargetCandidate*> _targetScoringCandidates;
+	std::vector<std::uint32_t> _targetScoringRanking;
+
+	// leaning of every actor updated since the batch was last solved, gathered by the actor updates that can run on several threads
+	Lock _leaningLock;
+	FrameContext _leaningFrameContext;  // copy of _frameContext for the actor updates, which would race the main update rebuilding it
+	LeaningBatch _leaningBatch;
+	std::vector<RE::ActorHandle> _leaningActors;
+	LeaningLODScheduler _leaningLODScheduler;  // under _leaningLock
+	static constexpr float _leaningLODBodyHeight = 64.f;
+	static constexpr float _leaningLODScreenMargin = 0.1f;
+	static constexpr float _leaningUprightTolerance = 1e-3f;  // above the graph variable write epsilon, which would drop the last step to zero
 
 	// Compatibility
 	RE::TESGlobal* _IFPV_IsFirstPerson = nullptr;
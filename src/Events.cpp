@@ -1,4 +1,7 @@
 #include "Events.h"
+#include "ActorMetadataCache.h"
+#include "BoneCache.h"
+#include "GraphVariableCache.h"
 #include "Settings.h"
 #include "DirectionalMovementHandler.h"
 #include "Offsets.h"
@@ -219,6 +222,12 @@ namespace Events
 		logger::info("Registered {}"sv, typeid(RE::TESDeathEvent).name());
 		scriptEventSourceHolder->GetEventSource<RE::TESEnterBleedoutEvent>()->AddEventSink(EventHandler::GetSingleton());
 		logger::info("Registered {}"sv, typeid(RE::TESEnterBleedoutEvent).name());
+		scriptEventSourceHolder->GetEventSource<RE::TESObjectLoadedEvent>()->AddEventSink(EventHandler::GetSingleton());
+		logger::info("Registered {}"sv, typeid(RE::TESObjectLoadedEvent).name());
+		scriptEventSourceHolder->GetEventSource<RE::TESCombatEvent>()->AddEventSink(EventHandler::GetSingleton());
+		logger::info("Registered {}"sv, typeid(RE::TESCombatEvent).name());
+		scriptEventSourceHolder->GetEventSource<RE::TESSwitchRaceCompleteEvent>()->AddEventSink(EventHandler::GetSingleton());
+		logger::info("Registered {}"sv, typeid(RE::TESSwitchRaceCompleteEvent).name());
 	}
 
 	// On death - toggle target lock
@@ -226,6 +235,8 @@ namespace Events
 	{
 		auto directionalMovementHandler = DirectionalMovementHandler::GetSingleton();
 		if (a_event && a_event->actorDying) {
+			ActorMetadataCache::GetSingleton()->Invalidate(a_event->actorDying.get());
+			directionalMovementHandler->InvalidateTargetCandidate(a_event->actorDying.get());
 			if (directionalMovementHandler->HasTargetLocked() && directionalMovementHandler->GetTarget() == a_event->actorDying->GetHandle()) {
 				if (Settings::bAutoTargetNextOnDeath) {
 					directionalMovementHandler->ToggleTargetLock(true);
@@ -244,8 +255,10 @@ namespace Events
 		auto directionalMovementHandler = DirectionalMovementHandler::GetSingleton();
 		if (a_event && a_event->actor) {
 			auto actor = a_event->actor->As<RE::Actor>();
+			ActorMetadataCache::GetSingleton()->Invalidate(actor);
 			if (actor && actor->IsEssential())
 			{
+				directionalMovementHandler->InvalidateTargetCandidate(actor);
 				if (directionalMovementHandler->HasTargetLocked() && directionalMovementHandler->GetTarget() == a_event->actor->GetHandle()) {
 					if (Settings::bAutoTargetNextOnDeath) {
 						directionalMovementHandler->ToggleTargetLock(true);
@@ -259,6 +272,46 @@ namespace Events
 		return EventResult::kContinue;
 	}
 
+	// On 3D load/unload - drop cached bones and graph variables of the old 3D
+	EventResult EventHandler::ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>*)
+	{
+		if (a_event) {
+			BoneCache::GetSingleton()->Invalidate(a_event->formID);
+			auto refr = RE::TESForm::LookupByID<RE::TESObjectREFR>(a_event->formID);
+			ActorMetadataCache::GetSingleton()->Invalidate(refr);
+			GraphVariableCache::GetSingleton()->Invalidate(refr);
+		}
+
+		return EventResult::kContinue;
+	}
+
+	// On combat state change - hostility to the player may have changed
+	EventResult EventHandler::ProcessEvent(const RE::TESCombatEvent* a_event, RE::BSTEventSource<RE::TESCombatEvent>*)
+	{
+		if (a_event) {
+			auto actorMetadataCache = ActorMetadataCache::GetSingleton();
+			actorMetadataCache->Invalidate(a_event->actor.get());
+			actorMetadataCache->Invalidate(a_event->targetActor.get());
+			auto directionalMovementHandler = DirectionalMovementHandler::GetSingleton();
+			directionalMovementHandler->InvalidateTargetCandidate(a_event->actor.get());
+			directionalMovementHandler->InvalidateTargetCandidate(a_event->targetActor.get());
+		}
+
+		return EventResult::kContinue;
+	}
+
+	// On race switch - race size, body part data and behavior graph changed
+	EventResult EventHandler::ProcessEvent(const RE::TESSwitchRaceCompleteEvent* a_event, RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>*)
+	{
+		if (a_event) {
+			ActorMetadataCache::GetSingleton()->Invalidate(a_event->subject.get());
+			GraphVariableCache::GetSingleton()->Invalidate(a_event->subject.get());
+			DirectionalMovementHandler::GetSingleton()->InvalidateTargetCandidate(a_event->subject.get());
+		}
+
+		return EventResult::kContinue;
+	}
+
 	void SinkEventHandlers()
 	{
 		InputEventHandler::Register();
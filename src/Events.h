@@ -56,7 +56,10 @@ namespace Events
 
 	class EventHandler : 
 		public RE::BSTEventSink<RE::TESDeathEvent>,
-		public RE::BSTEventSink<RE::TESEnterBleedoutEvent>
+		public RE::BSTEventSink<RE::TESEnterBleedoutEvent>,
+		public RE::BSTEventSink<RE::TESObjectLoadedEvent>,
+		public RE::BSTEventSink<RE::TESCombatEvent>,
+		public RE::BSTEventSink<RE::TESSwitchRaceCompleteEvent>
 	{
 	public:
 		static EventHandler* GetSingleton();
@@ -64,6 +67,9 @@ namespace Events
 
 		virtual EventResult ProcessEvent(const RE::TESDeathEvent* a_event, RE::BSTEventSource<RE::TESDeathEvent>* a_eventSource) override;
 		virtual EventResult ProcessEvent(const RE::TESEnterBleedoutEvent* a_event, RE::BSTEventSource<RE::TESEnterBleedoutEvent>* a_eventSource) override;
+		virtual EventResult ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>* a_eventSource) override;
+		virtual EventResult ProcessEvent(const RE::TESCombatEvent* a_event, RE::BSTEventSource<RE::TESCombatEvent>* a_eventSource) override;
+		virtual EventResult ProcessEvent(const RE::TESSwitchRaceCompleteEvent* a_event, RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>* a_eventSource) override;
 
 	private:
 		EventHandler() = default;
@@ -0,0 +1,45 @@
+#include "FrameContext.h"
+#include "Offsets.h"
+#include "Utils.h"
+#include "VectorMath.h"
+
+void FrameContext::Build(std::uint32_t a_frame)
+{
+	frame = a_frame;
+
+	playerCharacter = RE::PlayerCharacter::GetSingleton();
+	playerCamera = RE::PlayerCamera::GetSingleton();
+
+	playerDeltaTime = GetPlayerDeltaTime();
+	realTimeDeltaTime = GetRealTimeDeltaTime();
+
+	std::memcpy(worldToCamMatrix, reinterpret_cast<void*>(g_worldToCamMatrix), sizeof(worldToCamMatrix));
+	viewPort = *g_viewPort;
+
+	if (playerCharacter) {
+		playerPosition = playerCharacter->GetPosition();
+		playerAngle = playerCharacter->data.angle;
+		bHasTorsoPosition = GetTorsoPos(playerCharacter, torsoPosition);
+		cameraPosition = GetCameraPos();
+	} else {
+		bHasTorsoPosition = false;
+	}
+
+	cameraForwardVector = { 0.f, 1.f, 0.f };
+	if (playerCamera && playerCamera->currentState) {
+		playerCamera->currentState->GetRotation(cameraRotation);
+		cameraForwardVector = RotateVector(cameraForwardVector, cameraRotation);
+		cameraForwardVector.z = 0.f;
+		cameraForwardVector.Unitize();
+	}
+}
+
+bool FrameContext::WorldPtToScreenPt3(const RE::NiPoint3& a_point, RE::NiPoint2& a_outScreenPoint, float& a_outDepth) const
+{
+	return RE::NiCamera::WorldPtToScreenPt3((float(*)[4])worldToCamMatrix, viewPort, a_point, a_outScreenPoint.x, a_outScreenPoint.y, a_outDepth, 1e-5f);
+}
+
+void FrameContext::WorldPtsToScreenPts3(std::span<const RE::NiPoint3> a_points, std::span<RE::NiPoint2> a_outScreenPoints, std::span<float> a_outDepths) const
+{
+	VectorMath::WorldPtsToScreenPts3(worldToCamMatrix, viewPort, a_points, a_outScreenPoints, a_outDepths);
+}
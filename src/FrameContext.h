@@ -0,0 +1,33 @@
+#pragma once
+
+// Snapshot of the player and camera state taken once at the top of DirectionalMovementHandler::Update, so every phase and hook in the frame
+// works from the same view without re-reading the engine. Values are as they were at the start of the frame, phases that rotate the player
+// or the camera keep reading those live.
+struct FrameContext
+{
+	void Build(std::uint32_t a_frame);
+
+	bool WorldPtToScreenPt3(const RE::NiPoint3& a_point, RE::NiPoint2& a_outScreenPoint, float& a_outDepth) const;
+	// batched, points behind the camera come out with a negative depth and no usable screen position
+	void WorldPtsToScreenPts3(std::span<const RE::NiPoint3> a_points, std::span<RE::NiPoint2> a_outScreenPoints, std::span<float> a_outDepths) const;
+
+	std::uint32_t frame = 0;
+
+	RE::PlayerCharacter* playerCharacter = nullptr;
+	RE::PlayerCamera* playerCamera = nullptr;
+
+	RE::NiPoint3 playerPosition;
+	RE::NiPoint3 playerAngle;
+	bool bHasTorsoPosition = false;
+	RE::NiPoint3 torsoPosition;
+
+	RE::NiPoint3 cameraPosition;
+	RE::NiQuaternion cameraRotation;
+	RE::NiPoint3 cameraForwardVector;  // flattened to the XY plane
+
+	float worldToCamMatrix[4][4]{};
+	RE::NiRect<float> viewPort;
+
+	float playerDeltaTime = 0.f;
+	float realTimeDeltaTime = 0.f;
+};
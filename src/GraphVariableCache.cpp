@@ -0,0 +1,279 @@
+#include "GraphVariableCache.h"
+#include "Profiler.h"
+
+namespace
+{
+	constexpr std::array<std::string_view, static_cast<std::size_t>(GraphVariableCache::Variable::kTotal)> variableNames{
+		"TDM_VelocityX"sv,
+		"TDM_VelocityY"sv,
+		"TDM_Pitch"sv,
+		"TDM_Roll"sv,
+		"TDM_SpineTurn"sv,
+		"TDM_Dodge"sv,
+		"TDM_LockRotation"sv,
+		"tdmHeadtrackingSKSE"sv
+	};
+
+	static_assert(sizeof(RE::hkbVariableValue) == sizeof(float));
+}
+
+bool GraphVariableCache::Variables::GetFloat(Variable a_variable, float& a_outValue) const
+{
+	if (auto value = Get(a_variable)) {
+		std::memcpy(&a_outValue, value, sizeof(float));
+		return true;
+	}
+
+	return false;
+}
+
+bool GraphVariableCache::Variables::GetBool(Variable a_variable, bool& a_outValue) const
+{
+	if (auto value = Get(a_variable)) {
+		std::int32_t word;
+		std::memcpy(&word, value, sizeof(word));
+		a_outValue = word != 0;
+		return true;
+	}
+
+	return false;
+}
+
+bool GraphVariableCache::Variables::SetFloat(Variable a_variable, float a_value) const
+{
+	if (!Get(a_variable)) {
+		return false;
+	}
+
+	const Write write{ a_variable, a_value };
+	GraphVariableCache::GetSingleton()->QueueWrites(_actorHandle, { &write, 1 });
+	return true;
+}
+
+GraphVariableCache* GraphVariableCache::GetSingleton()
+{
+	static GraphVariableCache singleton;
+	return std::addressof(singleton);
+}
+
+bool GraphVariableCache::Get(RE::Actor* a_actor, Variables& a_outVariables)
+{
+	if (!a_actor) {
+		return false;
+	}
+
+	GraphKey graph;
+	auto behaviorGraph = GetActiveBehaviorGraph(a_actor, graph);
+	if (!behaviorGraph) {
+		return false;
+	}
+
+	Locker locker(_lock);
+
+	const auto actorHandle = a_actor->GetHandle();
+	auto [it, bInserted] = _entries.try_emplace(actorHandle.native_handle());
+	auto& entry = it->second;
+	if (bInserted || entry.graph != graph) {
+		entry.actorHandle = actorHandle;
+		entry.graph = graph;
+		entry.variables = Variables{};
+		entry.variables._actorHandle = actorHandle.native_handle();
+		entry.pendingMask = 0;  // queued for the old graph, Flush skips the entry
+		Resolve(behaviorGraph, entry.variables);
+	}
+	entry.lastUsedFrame = _frame;
+
+	a_outVariables = entry.variables;
+	return true;
+}
+
+void GraphVariableCache::SetFloats(RE::ActorHandle a_actorHandle, std::span<const Write> a_writes)
+{
+	QueueWrites(a_actorHandle.native_handle(), a_writes);
+}
+
+void GraphVariableCache::Flush()
+{
+	{
+		Locker locker(_lock);
+
+		for (auto actorHandle : _pendingEntries) {
+			auto it = _entries.find(actorHandle);
+			if (it == _entries.end()) {
+				continue;
+			}
+
+			auto& entry = it->second;
+			entry.bQueued = false;
+			const auto pendingMask = std::exchange(entry.pendingMask, 0);
+			if (!pendingMask) {
+				continue;
+			}
+
+			// the graph may have been swapped since the writes were queued
+			auto actor = entry.actorHandle.get();
+			GraphKey graph;
+			if (!actor || !GetActiveBehaviorGraph(actor.get(), graph) || graph != entry.graph) {
+				continue;
+			}
+
+			for (std::size_t variable = 0; variable < entry.pendingValues.size(); ++variable) {
+				if (pendingMask & (1u << variable)) {
+					if (graph.graphCount > 1) {
+						// the variable was only resolved in the active graph, the engine sets it in all of them
+						_engineWrites.push_back({ entry.actorHandle, static_cast<Variable>(variable), entry.pendingValues[variable] });
+					} else {
+						std::memcpy(entry.variables._values[variable], &entry.pendingValues[variable], sizeof(float));
+					}
+				}
+			}
+
+			Profiler::Count(Profiler::Counter::kGraphVariableWriteIssued, static_cast<std::uint32_t>(std::popcount(pendingMask)));
+		}
+
+		_pendingEntries.clear();
+	}
+
+	// hooks on the engine setters may look graph variables up again
+	for (const auto& write : _engineWrites) {
+		if (auto actor = write.actorHandle.get()) {
+			actor->SetGraphVariableFloat(variableNames[static_cast<std::size_t>(write.variable)].data(), write.value);
+		}
+	}
+	_engineWrites.clear();
+}
+
+void GraphVariableCache::Update(std::uint32_t a_frame)
+{
+	Locker locker(_lock);
+
+	_frame = a_frame;
+	std::erase_if(_entries, [&](const auto& a_entry) { return _frame - a_entry.second.lastUsedFrame > _maxUnusedAge; });
+}
+
+void GraphVariableCache::Invalidate(RE::ActorHandle a_actorHandle)
+{
+	Locker locker(_lock);
+
+	_entries.erase(a_actorHandle.native_handle());
+}
+
+void GraphVariableCache::Invalidate(RE::TESObjectREFR* a_refr)
+{
+	if (auto actor = a_refr ? a_refr->As<RE::Actor>() : nullptr) {
+		Invalidate(actor->GetHandle());
+	}
+}
+
+void GraphVariableCache::Clear()
+{
+	Locker locker(_lock);
+
+	_entries.clear();
+	_pendingEntries.clear();
+}
+
+RE::hkbBehaviorGraph* GraphVariableCache::GetActiveBehaviorGraph(RE::Actor* a_actor, GraphKey& a_outKey)
+{
+	RE::BSTSmartPointer<RE::BSAnimationGraphManager> animationGraphManagerPtr;
+	a_actor->GetAnimationGraphManager(animationGraphManagerPtr);
+	if (!animationGraphManagerPtr) {
+		return nullptr;
+	}
+
+	const auto activeGraph = animationGraphManagerPtr->GetRuntimeData().activeGraph;
+	if (activeGraph >= animationGraphManagerPtr->graphs.size()) {
+		return nullptr;
+	}
+
+	RE::BShkbAnimationGraph* animationGraph = animationGraphManagerPtr->graphs[activeGraph].get();
+	if (!animationGraph) {
+		return nullptr;
+	}
+
+	auto behaviorGraph = animationGraph->GetRuntimeData().behaviorGraph;
+	if (!behaviorGraph || !behaviorGraph->variableValueSet) {
+		return nullptr;
+	}
+
+	auto& values = behaviorGraph->variableValueSet->wordVariableValues;
+	a_outKey.behaviorGraph = behaviorGraph;
+	a_outKey.values = values.data();
+	a_outKey.valueCount = values.size();
+	a_outKey.graphCount = animationGraphManagerPtr->graphs.size();
+
+	return behaviorGraph;
+}
+
+void GraphVariableCache::Resolve(RE::hkbBehaviorGraph* a_behaviorGraph, Variables& a_outVariables)
+{
+	if (!a_behaviorGraph->data || !a_behaviorGraph->data->stringData) {
+		return;
+	}
+
+	// the root graph's variable values are in the same order as its variable names
+	auto& names = a_behaviorGraph->data->stringData->variableNames;
+	auto& values = a_behaviorGraph->variableValueSet->wordVariableValues;
+	const auto count = std::min(names.size(), values.size());
+
+	for (std::int32_t i = 0; i < count; ++i) {
+		const char* name = names[i].c_str();
+		if (!name) {
+			continue;
+		}
+
+		for (std::size_t variable = 0; variable < variableNames.size(); ++variable) {
+			if (_stricmp(name, variableNames[variable].data()) == 0) {  // graph variable names are case insensitive, like BSFixedString
+				a_outVariables._values[variable] = std::addressof(values[i]);
+				break;
+			}
+		}
+	}
+}
+
+void GraphVariableCache::QueueWrites(std::uint32_t a_actorHandle, std::span<const Write> a_writes)
+{
+	Locker locker(_lock);
+
+	auto it = _entries.find(a_actorHandle);
+	if (it == _entries.end()) {  // invalidated since the variables were handed out
+		return;
+	}
+
+	auto& entry = it->second;
+	for (const auto& write : a_writes) {
+		if (entry.variables.Has(write.variable)) {
+			QueueWrite(entry, a_actorHandle, write.variable, write.value);
+		}
+	}
+}
+
+void GraphVariableCache::QueueWrite(Entry& a_entry, std::uint32_t a_actorHandle, Variable a_variable, float a_value)
+{
+	const auto index = static_cast<std::size_t>(a_variable);
+	const std::uint32_t bit = 1u << index;
+
+	// a write that replaces an earlier one of this frame, or that the graph already holds, never reaches the graph. Only the active graph's
+	// value is known, with more than one graph the others may differ and the write goes through.
+	const bool bReplaced = (a_entry.pendingMask & bit) != 0;
+
+	float currentValue;
+	std::memcpy(&currentValue, a_entry.variables._values[index], sizeof(currentValue));
+
+	if (a_entry.graph.graphCount <= 1 && std::fabs(currentValue - a_value) <= _writeEpsilon) {
+		a_entry.pendingMask &= ~bit;
+		Profiler::Count(Profiler::Counter::kGraphVariableWriteSuppressed);
+		return;
+	}
+
+	if (bReplaced) {
+		Profiler::Count(Profiler::Counter::kGraphVariableWriteSuppressed);
+	}
+
+	if (!a_entry.bQueued) {
+		_pendingEntries.push_back(a_actorHandle);
+		a_entry.bQueued = true;
+	}
+	a_entry.pendingMask |= bit;
+	a_entry.pendingValues[index] = a_value;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+// Storage of the behavior graph variables that are read or written every frame, resolved by name once per graph. Entries are keyed by actor
+// and checked against the actor's active graph on every use, so a graph reload or swap resolves them again. Dropped on 3D load and race switch.
+// Float writes are queued and applied to every graph of the actor once per frame by Flush. For an actor with a single graph, a write to the value
+// it already holds (within _writeEpsilon) is dropped. Every write but the last is dropped when the same variable is set several times in a frame. Variables that must
+// take effect immediately, like the headtracking ones, are set through the engine instead.
+class GraphVariableCache
+{
+public:
+	enum class Variable : std::uint32_t
+	{
+		kVelocityX,
+		kVelocityY,
+		kPitch,
+		kRoll,
+		kSpineTurn,
+		kDodge,
+		kLockRotation,
+		kHeadtrackingSKSE,
+
+		kTotal
+	};
+
+	// The variables of one actor's active graph. Points into the graph, so it must not be kept past the call that got it.
+	class Variables
+	{
+	public:
+		[[nodiscard]] bool Has(Variable a_variable) const { return Get(a_variable) != nullptr; }
+
+		// reads see what the graph holds, not writes queued in the same frame
+		bool GetFloat(Variable a_variable, float& a_outValue) const;
+		bool GetBool(Variable a_variable, bool& a_outValue) const;
+
+		// queued until the next Flush, false if the graph doesn't have the variable
+		bool SetFloat(Variable a_variable, float a_value) const;
+
+	private:
+		friend class GraphVariableCache;
+
+		[[nodiscard]] RE::hkbVariableValue* Get(Variable a_variable) const { return _values[static_cast<std::size_t>(a_variable)]; }
+
+		std::array<RE::hkbVariableValue*, static_cast<std::size_t>(Variable::kTotal)> _values{};
+		std::uint32_t _actorHandle = 0;
+	};
+
+	struct Write
+	{
+		Variable variable;
+		float value;
+	};
+
+	static GraphVariableCache* GetSingleton();
+
+	// false if the actor has no behavior graph
+	bool Get(RE::Actor* a_actor, Variables& a_outVariables);
+
+	// queues several writes under one lock, without resolving the actor. Writes to variables its graph doesn't have, or to an actor that
+	// wasn't handed out since it was invalidated, are dropped.
+	void SetFloats(RE::ActorHandle a_actorHandle, std::span<const Write> a_writes);
+
+	// applies the writes queued since the last call, once per frame
+	void Flush();
+
+	void Update(std::uint32_t a_frame);
+	void Invalidate(RE::ActorHandle a_actorHandle);
+	void Invalidate(RE::TESObjectREFR* a_refr);
+	void Clear();
+
+private:
+	using Lock = std::mutex;
+	using Locker = std::lock_guard<Lock>;
+
+	// the graph the variables were resolved in, any difference means it was reloaded
+	struct GraphKey
+	{
+		bool operator==(const GraphKey&) const = default;
+
+		const RE::hkbBehaviorGraph* behaviorGraph = nullptr;
+		const RE::hkbVariableValue* values = nullptr;
+		std::int32_t valueCount = 0;
+		std::uint32_t graphCount = 0;
+	};
+
+	struct Entry
+	{
+		RE::ActorHandle actorHandle;
+		GraphKey graph;
+		Variables variables;
+		std::array<float, static_cast<std::size_t>(Variable::kTotal)> pendingValues{};
+		std::uint32_t pendingMask = 0;
+		std::uint32_t lastUsedFrame = 0;
+		bool bQueued = false;  // in _pendingEntries, which the mask alone can't tell once a write was dropped again
+	};
+
+	// a write to an actor with more than one graph, issued through the engine after Flush lets go of the lock
+	struct EngineWrite
+	{
+		RE::ActorHandle actorHandle;
+		Variable variable;
+		float value;
+	};
+
+	static_assert(static_cast<std::size_t>(Variable::kTotal) <= 32);
+
+	static constexpr std::uint32_t _maxUnusedAge = 600;  // frames before an unused entry is dropped
+	static constexpr float _writeEpsilon = 1e-4f;
+
+	GraphVariableCache() = default;
+	GraphVariableCache(const GraphVariableCache&) = delete;
+	GraphVariableCache(GraphVariableCache&&) = delete;
+	~GraphVariableCache() = default;
+
+	GraphVariableCache& operator=(const GraphVariableCache&) = delete;
+	GraphVariableCache& operator=(GraphVariableCache&&) = delete;
+
+	static RE::hkbBehaviorGraph* GetActiveBehaviorGraph(RE::Actor* a_actor, GraphKey& a_outKey);
+	static void Resolve(RE::hkbBehaviorGraph* a_behaviorGraph, Variables& a_outVariables);
+
+	void QueueWrites(std::uint32_t a_actorHandle, std::span<const Write> a_writes);
+	void QueueWrite(Entry& a_entry, std::uint32_t a_actorHandle, Variable a_variable, float a_value);  // _lock held
+
+	mutable Lock _lock;
+	std::unordered_map<std::uint32_t, Entry> _entries;  // keyed by native actor handle
+	std::vector<std::uint32_t> _pendingEntries;  // entries with queued writes
+	std::vector<EngineWrite> _engineWrites;  // only used by Flush
+	std::uint32_t _frame = 0;
+};
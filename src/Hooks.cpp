@@ -818,18 +818,7 @@ namespace Hooks
 		if (projectileNode && shooter.native_handle() == 0x100000) {
 			auto directionalMovementHandler = DirectionalMovementHandler::GetSingleton();
 			if (directionalMovementHandler->HasTargetLocked() || desiredTarget.native_handle() != 0) {
-				TargetLockProjectileAimType aimType;
-
-				switch (a_this->formType.get()) {
-				case RE::FormType::ProjectileArrow:
-					aimType = Settings::uTargetLockArrowAimType;
-					break;
-				case RE::FormType::ProjectileMissile:
-					aimType = Settings::uTargetLockMissileAimType;
-					break;
-				default:
-					aimType = TargetLockProjectileAimType::kFreeAim;
-				}
+				const auto aimType = DirectionalMovementHandler::GetProjectileAimType(a_this);
 
 				if (aimType != TargetLockProjectileAimType::kFreeAim) {
 					if (!desiredTarget.get()) {
@@ -847,7 +836,7 @@ namespace Hooks
 							if (desiredTarget) {
 								RE::NiPoint3 targetPos = targetPoint->world.translate;
 								RE::NiPoint3 targetVelocity;
-								target.get()->GetLinearVelocity(targetVelocity);
+								directionalMovementHandler->GetTargetVelocity(target, targetVelocity);
 
 								float projectileGravity = 0.f;
 								if (auto ammo = a_this->GetProjectileRuntimeData().ammoSource) {
@@ -867,24 +856,16 @@ namespace Hooks
 
 								auto& linearVelocity = a_this->GetProjectileRuntimeData().linearVelocity;
 
-								PredictAimProjectile(a_this->data.location, targetPos, targetVelocity, projectileGravity, linearVelocity);
+								directionalMovementHandler->PredictProjectileVelocity(a_this->data.location, target, targetPos, targetVelocity, projectileGravity, linearVelocity);
 
 								// rotate
 								RE::NiPoint3 direction = linearVelocity;
 								direction.Unitize();
 
-								a_this->data.angle.x = asin(direction.z);
-								a_this->data.angle.z = atan2(direction.x, direction.y);
-
-								if (a_this->data.angle.z < 0.0) {
-									a_this->data.angle.z += PI;
-								}
-
-								if (direction.x < 0.0) {
-									a_this->data.angle.z += PI;
-								}
-
-								SetRotationMatrix(projectileNode->local.rotate, -direction.x, direction.y, direction.z);
+								const auto orientation = GetProjectileOrientation(direction);
+								a_this->data.angle.x = orientation.pitch;
+								a_this->data.angle.z = orientation.yaw;
+								projectileNode->local.rotate = orientation.rotation;
 							}
 						}
 					}
@@ -892,36 +873,9 @@ namespace Hooks
 					
 					if (aimType == TargetLockProjectileAimType::kHoming) {
 						// homing
-						auto targetPoint = directionalMovementHandler->GetProjectileTargetPoint(a_this->GetHandle());
-						if (targetPoint) {
-							RE::NiPoint3 targetPos = targetPoint->world.translate;
-							auto& linearVelocity = a_this->GetProjectileRuntimeData().linearVelocity;
-							float speed = linearVelocity.Length();
-
-							//if (speed < 1500.f) {
-							//	return _GetLinearVelocity(a_this, a_outVelocity);
-							//}
-
-							RE::NiPoint3 direction = (targetPos - a_this->data.location);
-
-							// normalize direction
-							direction.Unitize();
-
-							// rotate
-							a_this->data.angle.x = asin(direction.z);
-							a_this->data.angle.z = atan2(direction.x, direction.y);
-
-							if (a_this->data.angle.z < 0.0) {
-								a_this->data.angle.z += PI;
-							}
-
-							if (direction.x < 0.0) {
-								a_this->data.angle.z += PI;
-							}
-
-							SetRotationMatrix(projectileNode->local.rotate, -direction.x, direction.y, direction.z);
-							linearVelocity = direction * speed;
-						}
+						directionalMovementHandler->ApplyProjectileGuidance(a_this, projectileNode);
+					} else if (aimType == TargetLockProjectileAimType::kProportionalNavigation) {
+						directionalMovementHandler->ApplyProjectileNavigation(a_this, projectileNode);
 					}
 				}
 			}
@@ -972,17 +926,10 @@ namespace Hooks
 					// normalize direction
 					direction.Unitize();
 
-					// rotate
-					a_this->data.angle.x = atan2(-direction.z, std::sqrtf(direction.x * direction.x + direction.y * direction.y));
-					a_this->data.angle.z = atan2(direction.x, direction.y);
-
-					if (a_this->data.angle.z < 0.0) {
-						a_this->data.angle.z += PI;
-					}
-
-					if (direction.x < 0.0) {
-						a_this->data.angle.z += PI;
-					}
+					// rotate, beams pitch the other way
+					const auto orientation = GetProjectileOrientation(direction);
+					a_this->data.angle.x = -orientation.pitch;
+					a_this->data.angle.z = orientation.yaw;
 				}
 			}
 		}
@@ -1634,9 +1581,13 @@ namespace Hooks
 
 	void PlayerCameraHook::Update(RE::TESCamera* a_this)
 	{
+		// the camera follows the actors, so their updates are done for this frame
+		auto directionalMovementHandler = DirectionalMovementHandler::GetSingleton();
+		directionalMovementHandler->FinishActorUpdates();
+
 		_Update(a_this);
 
-		DirectionalMovementHandler::GetSingleton()->UpdatePlayerPitch();
+		directionalMovementHandler->UpdatePlayerPitch();
 	}
 
 	void PlayerCameraHook::SetCameraState(RE::TESCamera* a_this, RE::TESCameraState* a_newState)
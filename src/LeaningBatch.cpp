@@ -0,0 +1,84 @@
+#include "LeaningBatch.h"
+#include "MathUtils.h"
+
+void LeaningBatch::Clear()
+{
+	_forwardX.clear();
+	_forwardY.clear();
+	_speedPct.clear();
+	_heading.clear();
+	_deltaTime.clear();
+	_upright.clear();
+	_staleVelocity.clear();
+	_velocityX.clear();
+	_velocityY.clear();
+	_pitch.clear();
+	_roll.clear();
+}
+
+std::uint32_t LeaningBatch::Add(const RE::NiPoint2& a_forward, float a_speedPct, float a_heading, float a_deltaTime, const RE::NiPoint2& a_previousVelocity, float a_previousPitch, float a_previousRoll, bool a_bUpright, bool a_bStaleVelocity /*= false*/)
+{
+	const auto index = GetSize();
+
+	_forwardX.push_back(a_forward.x);
+	_forwardY.push_back(a_forward.y);
+	_speedPct.push_back(a_speedPct);
+	_heading.push_back(a_heading);
+	_deltaTime.push_back(a_deltaTime);
+	_upright.push_back(a_bUpright ? 1 : 0);
+	_staleVelocity.push_back(a_bStaleVelocity ? 1 : 0);
+	_velocityX.push_back(a_previousVelocity.x);
+	_velocityY.push_back(a_previousVelocity.y);
+	_pitch.push_back(a_previousPitch);
+	_roll.push_back(a_previousRoll);
+
+	return index;
+}
+
+void LeaningBatch::Solve(const Parameters& a_parameters)
+{
+	const float maxStrength = a_parameters.maxLeaningStrength;
+
+	for (std::uint32_t i = 0; i < GetSize(); ++i) {
+		const float deltaTime = _deltaTime[i];
+		float desiredPitch = 0.f;
+		float desiredRoll = 0.f;
+
+		if (!_upright[i]) {
+			const float velocityScale = -_speedPct[i] * a_parameters.leaningMult;
+			const RE::NiPoint2 velocity{ _forwardX[i] * velocityScale, _forwardY[i] * velocityScale };
+
+			// calculate acceleration, none from a stale velocity
+			const float inverseDeltaTime = deltaTime > 0.f && !_staleVelocity[i] ? 1.f / deltaTime : 0.f;
+			RE::NiPoint2 acceleration{ (velocity.x - _velocityX[i]) * inverseDeltaTime, (velocity.y - _velocityY[i]) * inverseDeltaTime };
+
+			if (acceleration.x * velocity.x + acceleration.y * velocity.y <= 0.f) {
+				acceleration.x *= 0.5f;
+				acceleration.y *= 0.5f;
+			}
+
+			// clamp to sane values, same as ClampSizeMax
+			const float lengthSquared = acceleration.x * acceleration.x + acceleration.y * acceleration.y;
+			if (maxStrength < 1.e-4f) {
+				acceleration = { 0.f, 0.f };
+			} else if (lengthSquared > maxStrength * maxStrength) {
+				const float scale = maxStrength / std::sqrt(lengthSquared);
+				acceleration.x *= scale;
+				acceleration.y *= scale;
+			}
+
+			acceleration = Vec2Rotate(acceleration, _heading[i]);
+
+			// get desired lean
+			desiredPitch = acceleration.y;
+			desiredRoll = acceleration.x;
+
+			_velocityX[i] = velocity.x;
+			_velocityY[i] = velocity.y;
+		}
+
+		// interpolate
+		_roll[i] = InterpTo(_roll[i], desiredRoll, deltaTime, a_parameters.leaningSpeed);
+		_pitch[i] = InterpTo(_pitch[i], desiredPitch, deltaTime, a_parameters.leaningSpeed);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// Structure of arrays batch of leaning states. The inputs are gathered from the actors, Solve is pure math over the arrays and leaves the
+// new velocity, pitch and roll in place of the previous ones, to be written back to the graphs. Solved on the calling thread, a scene's
+// high process actors take less time than handing the batch to other threads would.
+class LeaningBatch
+{
+public:
+	struct Parameters
+	{
+		float leaningMult = 1.f;
+		float leaningSpeed = 1.f;
+		float maxLeaningStrength = 0.f;
+	};
+
+	void Clear();
+
+	// a_forward is the character controller's forward vector and a_heading the actor's yaw, a_deltaTime the time since the entry was last
+	// solved. An upright entry only brings its lean back to zero. An entry with a stale previous velocity, like one that was upright for a
+	// while, only takes up the new velocity without leaning into the difference. Returns the index of the entry.
+	std::uint32_t Add(const RE::NiPoint2& a_forward, float a_speedPct, float a_heading, float a_deltaTime, const RE::NiPoint2& a_previousVelocity, float a_previousPitch, float a_previousRoll, bool a_bUpright, bool a_bStaleVelocity = false);
+	void Solve(const Parameters& a_parameters);
+
+	[[nodiscard]] std::uint32_t GetSize() const { return static_cast<std::uint32_t>(_speedPct.size()); }
+
+	// the velocity is only solved for entries that aren't upright
+	[[nodiscard]] bool HasVelocity(std::uint32_t a_index) const { return !_upright[a_index]; }
+	[[nodiscard]] RE::NiPoint2 GetVelocity(std::uint32_t a_index) const { return { _velocityX[a_index], _velocityY[a_index] }; }
+	[[nodiscard]] float GetPitch(std::uint32_t a_index) const { return _pitch[a_index]; }
+	[[nodiscard]] float GetRoll(std::uint32_t a_index) const { return _roll[a_index]; }
+
+private:
+	std::vector<float> _forwardX;
+	std::vector<float> _forwardY;
+	std::vector<float> _speedPct;
+	std::vector<float> _heading;
+	std::vector<float> _deltaTime;
+	std::vector<std::uint8_t> _upright;
+	std::vector<std::uint8_t> _staleVelocity;
+
+	// previous values until solved
+	std::vector<float> _velocityX;
+	std::vector<float> _velocityY;
+	std::vector<float> _pitch;
+	std::vector<float> _roll;
+};
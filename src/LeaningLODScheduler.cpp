@@ -0,0 +1,55 @@
+#include "LeaningLODScheduler.h"
+#include "Profiler.h"
+
+void LeaningLODScheduler::Update(std::uint32_t a_frame)
+{
+	_frame = a_frame;
+	std::erase_if(_entries, [&](const auto& a_entry) { return _frame - a_entry.second.lastUsedFrame > _maxUnusedAge; });
+}
+
+void LeaningLODScheduler::Clear()
+{
+	_entries.clear();
+}
+
+bool LeaningLODScheduler::Schedule(std::uint32_t a_actorHandle, Level a_level, std::uint32_t a_interval, float a_deltaTime, float& a_outDeltaTime, bool* a_outResumed /*= nullptr*/)
+{
+	if (a_outResumed) {
+		*a_outResumed = false;
+	}
+
+	if (a_level == Level::kFull || !a_actorHandle) {
+		// full rate actors aren't kept, unless they were frozen before
+		if (auto it = _entries.find(a_actorHandle); it != _entries.end() && it->second.bFrozen) {
+			it->second.bFrozen = false;
+			if (a_outResumed) {
+				*a_outResumed = true;
+			}
+		}
+
+		a_outDeltaTime = a_deltaTime;
+		return true;
+	}
+
+	auto& entry = _entries[a_actorHandle];
+	if (_frame - entry.lastUsedFrame > 1) {  // not updated since the previous frame, the pending time is stale
+		entry.pendingTime = 0.f;
+	}
+	entry.lastUsedFrame = _frame;
+	entry.pendingTime = std::min(entry.pendingTime + a_deltaTime, _maxPendingTime);
+
+	if (++entry.skippedUpdates < std::max(a_interval, 1u)) {
+		Profiler::Count(Profiler::Counter::kLeaningSkipped);
+		return false;
+	}
+
+	a_outDeltaTime = std::exchange(entry.pendingTime, 0.f);
+	entry.skippedUpdates = 0;
+
+	const bool bFrozen = a_level == Level::kFrozen;
+	if (a_outResumed) {
+		*a_outResumed = entry.bFrozen && !bFrozen;
+	}
+	entry.bFrozen = bFrozen;
+	return true;
+}
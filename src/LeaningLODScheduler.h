@@ -0,0 +1,38 @@
+#pragma once
+
+// Decides how often each actor's lean is solved. Full rate actors are solved on every update, reduced rate actors on every
+// uLeaningLODInterval-th update with the skipped time added to their delta time, frozen actors at the reduced rate until their lean has
+// gone back to upright and then not at all. Not locked, the actor updates call it under the lock they take for the leaning batch.
+class LeaningLODScheduler
+{
+public:
+	enum class Level : std::uint32_t
+	{
+		kFull,
+		kReduced,
+		kFrozen
+	};
+
+	void Update(std::uint32_t a_frame);
+	void Clear();
+
+	// false if the actor's lean is skipped this update, otherwise a_outDeltaTime is the time since it was last solved. a_actorHandle is the
+	// actor's native handle, a_interval the reduced rate's uLeaningLODInterval. a_outResumed is set on the first solve after the actor was
+	// frozen, its graph still holds the velocity from before that.
+	[[nodiscard]] bool Schedule(std::uint32_t a_actorHandle, Level a_level, std::uint32_t a_interval, float a_deltaTime, float& a_outDeltaTime, bool* a_outResumed = nullptr);
+
+private:
+	struct Entry
+	{
+		float pendingTime = 0.f;
+		std::uint32_t skippedUpdates = 0;
+		std::uint32_t lastUsedFrame = 0;
+		bool bFrozen = false;
+	};
+
+	static constexpr std::uint32_t _maxUnusedAge = 600;  // frames before an unused entry is dropped
+	static constexpr float _maxPendingTime = 0.25f;  // an actor that wasn't updated for a while starts over rather than catching up
+
+	std::unordered_map<std::uint32_t, Entry> _entries;  // keyed by native actor handle
+	std::uint32_t _frame = 0;
+};
@@ -0,0 +1,130 @@
+#include "LineOfSightScheduler.h"
+#include "Profiler.h"
+#include "Settings.h"
+
+void LineOfSightScheduler::Update(float a_deltaTime)
+{
+	_time += a_deltaTime;
+	_testsThisFrame = 0;
+	_timeThisFrame = std::chrono::nanoseconds::zero();
+
+	std::erase_if(_results, [&](const auto& a_entry) { return !a_entry.second.bQueued && _time - a_entry.second.time > _maxResultAge; });
+
+	// refresh what was denied last frame, but leave at least half of the budget to this frame's queries
+	const std::uint32_t budget = Settings::uTargetLockLOSBudget;
+	ProcessQueue(budget > 0 ? (budget + 1) / 2 : static_cast<std::uint32_t>(_queue.size()));
+}
+
+void LineOfSightScheduler::Clear()
+{
+	_results.clear();
+	_queue.clear();
+	_testsThisFrame = 0;
+	_timeThisFrame = std::chrono::nanoseconds::zero();
+}
+
+std::optional<bool> LineOfSightScheduler::Query(RE::Actor* a_actor, bool a_bPriority)
+{
+	if (!a_actor) {
+		return false;
+	}
+
+	auto& result = _results[a_actor->GetHandle().native_handle()];
+	if (result.bTested && IsFresh(result)) {
+		return result.bHasLOS;
+	}
+
+	if (a_bPriority || HasBudget()) {
+		Test(a_actor, result);
+		return result.bHasLOS;
+	}
+
+	Profiler::Count(Profiler::Counter::kLineOfSightDeferred);
+	if (!result.bQueued) {
+		result.bQueued = true;
+		_queue.push_back(a_actor->GetHandle());
+	}
+
+	return std::nullopt;
+}
+
+std::optional<bool> LineOfSightScheduler::GetLastResult(RE::Actor* a_actor) const
+{
+	if (!a_actor) {
+		return std::nullopt;
+	}
+
+	auto it = _results.find(a_actor->GetHandle().native_handle());
+	if (it == _results.end() || !it->second.bTested) {
+		return std::nullopt;
+	}
+
+	return it->second.bHasLOS;
+}
+
+bool LineOfSightScheduler::HasBudget() const
+{
+	if (Settings::uTargetLockLOSBudget > 0 && _testsThisFrame >= Settings::uTargetLockLOSBudget) {
+		return false;
+	}
+
+	if (Settings::fTargetLockLOSBudgetTime > 0.f && std::chrono::duration<float, std::micro>(_timeThisFrame).count() >= Settings::fTargetLockLOSBudgetTime) {
+		return false;
+	}
+
+	return true;
+}
+
+bool LineOfSightScheduler::IsFresh(const Result& a_result) const
+{
+	return _time - a_result.time <= Settings::fTargetLockLOSFreshness;
+}
+
+bool LineOfSightScheduler::Test(RE::Actor* a_actor, Result& a_result)
+{
+	auto playerCharacter = RE::PlayerCharacter::GetSingleton();
+	if (!playerCharacter) {
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	bool r8 = false;
+	a_result.bHasLOS = playerCharacter->HasLineOfSight(a_actor, r8);
+	a_result.bTested = true;
+	a_result.time = _time;
+
+	_timeThisFrame += std::chrono::steady_clock::now() - start;
+	++_testsThisFrame;
+	Profiler::Count(Profiler::Counter::kLineOfSightTested);
+
+	return a_result.bHasLOS;
+}
+
+void LineOfSightScheduler::ProcessQueue(std::uint32_t a_maxTests)
+{
+	std::uint32_t tests = 0;
+	while (!_queue.empty() && tests < a_maxTests && HasBudget()) {
+		auto handle = _queue.front();
+		_queue.pop_front();
+
+		auto it = _results.find(handle.native_handle());
+		if (it == _results.end()) {
+			continue;
+		}
+
+		auto& result = it->second;
+		result.bQueued = false;
+
+		if (result.bTested && IsFresh(result)) {
+			continue;
+		}
+
+		if (auto actor = handle.get()) {
+			Test(actor.get(), result);
+			++tests;
+		} else {
+			_results.erase(it);
+		}
+	}
+}
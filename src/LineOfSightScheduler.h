@@ -0,0 +1,39 @@
+#pragma once
+
+// Spreads the player's line of sight tests over frames. Results are reused while they are fresh, priority queries (the locked target and
+// anything the player asked for, like a lock-on or switch press) are always answered, everything else is tested while the per-frame
+// budget lasts and queued for a round-robin refresh otherwise.
+class LineOfSightScheduler
+{
+public:
+	void Update(float a_deltaTime);
+	void Clear();
+
+	// returns std::nullopt when there's no fresh result and the budget is spent, the actor is then refreshed on a later frame
+	[[nodiscard]] std::optional<bool> Query(RE::Actor* a_actor, bool a_bPriority);
+	// the last tested result however old, std::nullopt if the actor was never tested
+	[[nodiscard]] std::optional<bool> GetLastResult(RE::Actor* a_actor) const;
+
+private:
+	struct Result
+	{
+		float time = 0.f;
+		bool bHasLOS = false;
+		bool bTested = false;
+		bool bQueued = false;
+	};
+
+	static constexpr float _maxResultAge = 5.f;
+
+	[[nodiscard]] bool HasBudget() const;
+	[[nodiscard]] bool IsFresh(const Result& a_result) const;
+	bool Test(RE::Actor* a_actor, Result& a_result);
+	void ProcessQueue(std::uint32_t a_maxTests);
+
+	std::unordered_map<std::uint32_t, Result> _results;  // keyed by native actor handle
+	std::deque<RE::ActorHandle> _queue;
+
+	float _time = 0.f;
+	std::uint32_t _testsThisFrame = 0;
+	std::chrono::nanoseconds _timeThisFrame{ 0 };
+};
@@ -0,0 +1,297 @@
+#include "MathUtils.h"
+
+#include <emmintrin.h>
+
+void GetAngle(const RE::NiPoint3& a_from, const RE::NiPoint3& a_to, AngleZX& angle)
+{
+	const auto x = a_to.x - a_from.x;
+	const auto y = a_to.y - a_from.y;
+	const auto z = a_to.z - a_from.z;
+	const auto xy = sqrt(x * x + y * y);
+
+	angle.z = atan2(x, y);
+	angle.x = atan2(-z, xy);
+	angle.distance = sqrt(xy * xy + z * z);
+}
+
+namespace
+{
+	// SSE2 has no floor, truncate and step down where that rounded up. Magnitudes from 2^23 up are integral already
+	__m128 FloorPs(__m128 a_value)
+	{
+		const __m128 absValue = _mm_andnot_ps(_mm_set1_ps(-0.f), a_value);
+		const __m128 bIntegral = _mm_cmpge_ps(absValue, _mm_set1_ps(8388608.f));
+		__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a_value));
+		truncated = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a_value), _mm_set1_ps(1.f)));
+		return _mm_or_ps(_mm_and_ps(bIntegral, a_value), _mm_andnot_ps(bIntegral, truncated));
+	}
+
+	// Constant time wrap into [0, 2PI] or [-PI, PI], in range angles come back unchanged (the upper bound itself wraps to the lower one).
+	// Rounding can leave the result just outside of the range, which a single compare and step fixes, and the final clamp keeps even
+	// garbage input like 1e30 in range.
+	template <bool bRelative>
+	__m128 WrapAnglesPs(__m128 a_angles)
+	{
+		const __m128 twoPi = _mm_set1_ps(TWO_PI);
+		const __m128 inverseTwoPi = _mm_set1_ps(1.f / TWO_PI);
+		const __m128 lower = _mm_set1_ps(bRelative ? -PI : 0.f);
+		const __m128 upper = _mm_set1_ps(bRelative ? PI : TWO_PI);
+
+		const __m128 turns = FloorPs(_mm_mul_ps(_mm_sub_ps(a_angles, lower), inverseTwoPi));
+		a_angles = _mm_sub_ps(a_angles, _mm_mul_ps(twoPi, turns));
+		a_angles = _mm_add_ps(a_angles, _mm_and_ps(_mm_cmplt_ps(a_angles, lower), twoPi));
+		a_angles = _mm_sub_ps(a_angles, _mm_and_ps(_mm_cmpgt_ps(a_angles, upper), twoPi));
+		return _mm_min_ps(_mm_max_ps(a_angles, lower), upper);
+	}
+
+	template <bool bRelative>
+	void WrapAngles(std::span<float> a_angles)
+	{
+		std::size_t i = 0;
+		for (; i + 4 <= a_angles.size(); i += 4) {
+			_mm_storeu_ps(&a_angles[i], WrapAnglesPs<bRelative>(_mm_loadu_ps(&a_angles[i])));
+		}
+		for (; i < a_angles.size(); ++i) {
+			a_angles[i] = _mm_cvtss_f32(WrapAnglesPs<bRelative>(_mm_set_ss(a_angles[i])));
+		}
+	}
+}
+
+float NormalAbsoluteAngle(float a_angle)
+{
+	return _mm_cvtss_f32(WrapAnglesPs<false>(_mm_set_ss(a_angle)));
+}
+
+float NormalRelativeAngle(float a_angle)
+{
+	return _mm_cvtss_f32(WrapAnglesPs<true>(_mm_set_ss(a_angle)));
+}
+
+void NormalAbsoluteAngles(std::span<float> a_angles)
+{
+	WrapAngles<false>(a_angles);
+}
+
+void NormalRelativeAngles(std::span<float> a_angles)
+{
+	WrapAngles<true>(a_angles);
+}
+
+void SetRotationMatrix(RE::NiMatrix3& a_matrix, float sacb, float cacb, float sb)
+{
+	float cb = std::sqrtf(1 - sb * sb);
+	float ca = cacb / cb;
+	float sa = sacb / cb;
+	a_matrix.entry[0][0] = ca;
+	a_matrix.entry[0][1] = -sacb;
+	a_matrix.entry[0][2] = sa * sb;
+	a_matrix.entry[1][0] = sa;
+	a_matrix.entry[1][1] = cacb;
+	a_matrix.entry[1][2] = -ca * sb;
+	a_matrix.entry[2][0] = 0.0;
+	a_matrix.entry[2][1] = sb;
+	a_matrix.entry[2][2] = cb;
+}
+
+float FastAtan2(float a_y, float a_x)
+{
+	// minimax polynomial for atan on [0, 1], max error ~2e-6 radians, then mapped to the right octant
+	const float absX = std::fabs(a_x);
+	const float absY = std::fabs(a_y);
+	const float maxAbs = std::max(absX, absY);
+	if (maxAbs <= 0.f) {
+		return 0.f;
+	}
+
+	const float a = std::min(absX, absY) / maxAbs;
+	const float s = a * a;
+	float result = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+
+	if (absY > absX) {
+		result = 0.5f * PI - result;
+	}
+	if (a_x < 0.f) {
+		result = PI - result;
+	}
+	if (a_y < 0.f) {
+		result = -result;
+	}
+
+	return result;
+}
+
+ProjectileOrientation GetProjectileOrientation(const RE::NiPoint3& a_direction)
+{
+	// a_direction must be a unit vector, so cos(pitch) is the length of its horizontal part and the heading follows from a single division
+	ProjectileOrientation orientation;
+
+	const float horizontalLength = std::sqrtf(a_direction.x * a_direction.x + a_direction.y * a_direction.y);
+
+	orientation.pitch = FastAtan2(a_direction.z, horizontalLength);
+	orientation.yaw = FastAtan2(a_direction.x, a_direction.y);
+	if (orientation.yaw < 0.f) {
+		orientation.yaw += 2.f * PI;
+	}
+
+	float cosYaw = 1.f;
+	float sinYaw = 0.f;
+	if (horizontalLength > FLT_EPSILON) {
+		const float inverseLength = 1.f / horizontalLength;
+		cosYaw = a_direction.y * inverseLength;
+		sinYaw = -a_direction.x * inverseLength;
+	}
+
+	auto& matrix = orientation.rotation;
+	matrix.entry[0][0] = cosYaw;
+	matrix.entry[0][1] = a_direction.x;
+	matrix.entry[0][2] = sinYaw * a_direction.z;
+	matrix.entry[1][0] = sinYaw;
+	matrix.entry[1][1] = a_direction.y;
+	matrix.entry[1][2] = -cosYaw * a_direction.z;
+	matrix.entry[2][0] = 0.f;
+	matrix.entry[2][1] = a_direction.z;
+	matrix.entry[2][2] = horizontalLength;
+
+	return orientation;
+}
+
+bool PredictAimProjectile(RE::NiPoint3 a_projectilePos, RE::NiPoint3 a_targetPosition, RE::NiPoint3 a_targetVelocity, float a_gravity, RE::NiPoint3& a_projectileVelocity, float* a_outFlightTime)
+{
+	// http://ringofblades.com/Blades/Code/PredictiveAim.cs
+
+	float projectileSpeedSquared = a_projectileVelocity.SqrLength();
+	float projectileSpeed = std::sqrtf(projectileSpeedSquared);
+
+	if (projectileSpeed <= 0.f || a_projectilePos == a_targetPosition) {
+		return false;
+	}
+
+	float targetSpeedSquared = a_targetVelocity.SqrLength();
+	float targetSpeed = std::sqrtf(targetSpeedSquared);
+	RE::NiPoint3 targetToProjectile = a_projectilePos - a_targetPosition;
+	float distanceSquared = targetToProjectile.SqrLength();
+	float distance = std::sqrtf(distanceSquared);
+	RE::NiPoint3 direction = targetToProjectile;
+	direction.Unitize();
+	RE::NiPoint3 targetVelocityDirection = a_targetVelocity;
+	targetVelocityDirection.Unitize();
+
+	float cosTheta = (targetSpeedSquared > 0) 
+		? direction.Dot(targetVelocityDirection) 
+		: 1.0f;
+
+	bool bValidSolutionFound = true;
+	float t;
+
+	if (ApproximatelyEqual(projectileSpeedSquared, targetSpeedSquared)) {
+		// We want to avoid div/0 that can result from target and projectile traveling at the same speed
+		//We know that cos(theta) of zero or less means there is no solution, since that would mean B goes backwards or leads to div/0 (infinity)
+		if (cosTheta > 0) {
+			t = 0.5f * distance / (targetSpeed * cosTheta);
+		} else {
+			bValidSolutionFound = false;
+			t = 1;
+		}
+	} else {
+		float a = projectileSpeedSquared - targetSpeedSquared;
+		float b = 2.0f * distance * targetSpeed * cosTheta;
+		float c = -distanceSquared;
+		float discriminant = b * b - 4.0f * a * c;
+
+		if (discriminant < 0) {
+			// NaN
+			bValidSolutionFound = false;
+			t = 1;
+		} else {
+			// a will never be zero
+			float uglyNumber = sqrtf(discriminant);
+			float t0 = 0.5f * (-b + uglyNumber) / a;
+			float t1 = 0.5f * (-b - uglyNumber) / a;
+
+			// Assign the lowest positive time to t to aim at the earliest hit
+			t = fmin(t0, t1);
+			if (t < FLT_EPSILON) {
+				t = fmax(t0, t1);
+			}
+
+			if (t < FLT_EPSILON) {
+				// Time can't flow backwards when it comes to aiming.
+				// No real solution was found, take a wild shot at the target's future location
+				bValidSolutionFound = false;
+				t = 1;
+			}
+		}
+	}
+
+	a_projectileVelocity = a_targetVelocity + (-targetToProjectile / t);
+
+	if (!bValidSolutionFound)
+	{
+		a_projectileVelocity.Unitize();
+		a_projectileVelocity *= projectileSpeed;
+	}
+
+	if (!ApproximatelyEqual(a_gravity, 0.f))
+	{
+		float netFallDistance = (a_projectileVelocity * t).z;
+		float gravityCompensationSpeed = (netFallDistance + 0.5f * a_gravity * t * t) / t;
+		a_projectileVelocity.z = gravityCompensationSpeed;
+	}
+
+	if (a_outFlightTime) {
+		*a_outFlightTime = t;
+	}
+
+	return bValidSolutionFound;
+}
+
+bool PredictAimProjectileIterative(RE::NiPoint3 a_projectilePos, RE::NiPoint3 a_targetPosition, RE::NiPoint3 a_targetVelocity, float a_gravity, float a_drag, RE::NiPoint3& a_projectileVelocity, float* a_outFlightTime)
+{
+	// Fixed point iteration on the time of flight t: aim at where the target will be after t, solve the launch velocity that reaches
+	// that point in exactly t under gravity and linear drag, then rescale t so the launch speed matches the projectile's speed.
+	// Converges as long as the target is slower than the projectile and within range, otherwise falls back to the closed form solution.
+	constexpr std::uint32_t iterations = 8;
+	constexpr float maxFlightTime = 10.f;
+	constexpr float speedTolerance = 0.01f;
+
+	const float projectileSpeed = a_projectileVelocity.Length();
+
+	if (projectileSpeed <= 0.f || a_projectilePos == a_targetPosition) {
+		return false;
+	}
+
+	const bool bHasDrag = a_drag > FLT_EPSILON;
+	const float terminalSpeed = bHasDrag ? a_gravity / a_drag : 0.f;
+
+	auto getLaunchVelocity = [&](float a_time) {
+		RE::NiPoint3 displacement = a_targetPosition + a_targetVelocity * a_time - a_projectilePos;
+		RE::NiPoint3 velocity;
+		if (bHasDrag) {
+			// x(t) = (v0 + g/k) * (1 - e^-kt) / k - g/k * t, gravity on the vertical axis only
+			const float decay = (1.f - std::exp(-a_drag * a_time)) / a_drag;
+			displacement.z += terminalSpeed * a_time;
+			velocity = displacement / decay;
+			velocity.z -= terminalSpeed;
+		} else {
+			velocity = displacement / a_time;
+			velocity.z += 0.5f * a_gravity * a_time;
+		}
+		return velocity;
+	};
+
+	float t = a_projectilePos.GetDistance(a_targetPosition) / projectileSpeed;
+	for (std::uint32_t i = 0; i < iterations; ++i) {
+		t = std::min(t * getLaunchVelocity(t).Length() / projectileSpeed, maxFlightTime);
+	}
+
+	const RE::NiPoint3 velocity = getLaunchVelocity(t);
+	if (t >= maxFlightTime || std::fabs(velocity.Length() - projectileSpeed) > speedTolerance * projectileSpeed) {
+		return PredictAimProjectile(a_projectilePos, a_targetPosition, a_targetVelocity, a_gravity, a_projectileVelocity, a_outFlightTime);
+	}
+
+	a_projectileVelocity = velocity;
+	if (a_outFlightTime) {
+		*a_outFlightTime = t;
+	}
+	return true;
+}
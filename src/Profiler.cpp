@@ -0,0 +1,114 @@
+#include "Profiler.h"
+
+namespace Profiler
+{
+	namespace
+	{
+		constexpr std::uint32_t reportInterval = 600;  // frames
+
+		constexpr std::array<std::string_view, static_cast<std::size_t>(Phase::kTotal)> phaseNames{
+			"Update"sv,
+			"SolveLeaning"sv,
+			"UpdateGlobals"sv,
+			"ProgressTimers"sv,
+			"UpdateTargetLock"sv,
+			"UpdateTargetSwitchGraphs"sv,
+			"UpdateTweeningState"sv,
+			"UpdateFacingState"sv,
+			"UpdateFacingCrosshair"sv,
+			"UpdateDirectionalMovement"sv,
+			"UpdateDodgingState"sv,
+			"UpdateJumpingState"sv,
+			"UpdateMountedArchery"sv,
+			"UpdateTargetFacing"sv,
+			"UpdateRotation"sv,
+			"UpdateRotationLockedCam"sv,
+			"UpdateCameraAutoRotation"sv,
+			"UpdateCameraReset"sv,
+			"UpdateProjectileTargetMap"sv,
+			"UpdateProjectileGuidance"sv
+		};
+
+		constexpr std::array<std::string_view, static_cast<std::size_t>(Counter::kTotal)> counterNames{
+			"TargetValidityHit"sv,
+			"TargetValidityMiss"sv,
+			"LineOfSightSaved"sv,
+			"LineOfSightTested"sv,
+			"LineOfSightDeferred"sv,
+			"AimPredictionSolved"sv,
+			"AimPredictionReused"sv,
+			"GraphVariableWriteIssued"sv,
+			"GraphVariableWriteSuppressed"sv,
+			"LeaningSolved"sv,
+			"LeaningSkipped"sv
+		};
+
+		// current and the counters are added to from the actor update and projectile threads, total, max and the frame count are only
+		// touched by EndFrame on the main thread
+		struct PhaseStats
+		{
+			std::atomic<std::int64_t> current{ 0 };  // nanoseconds
+			std::chrono::nanoseconds total{ 0 };
+			std::chrono::nanoseconds max{ 0 };
+		};
+
+		std::array<PhaseStats, static_cast<std::size_t>(Phase::kTotal)> phaseStats{};
+		std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::kTotal)> counters{};
+		std::uint32_t frameCount = 0;
+
+		std::uint64_t GetCounter(Counter a_counter)
+		{
+			return counters[static_cast<std::size_t>(a_counter)].load(std::memory_order_relaxed);
+		}
+
+		void Report()
+		{
+			logger::info("Profiler: {} frames", frameCount);
+			for (std::size_t i = 0; i < phaseStats.size(); ++i) {
+				auto& stats = phaseStats[i];
+				const double average = std::chrono::duration<double, std::micro>(stats.total).count() / frameCount;
+				const double max = std::chrono::duration<double, std::micro>(stats.max).count();
+				logger::info("  {:<28} avg {:8.2f}us  max {:8.2f}us", phaseNames[i], average, max);
+			}
+			for (std::size_t i = 0; i < counters.size(); ++i) {
+				logger::info("  {:<28} avg {:8.2f}/frame", counterNames[i], static_cast<double>(counters[i].load(std::memory_order_relaxed)) / frameCount);
+			}
+
+			const auto validityLookups = GetCounter(Counter::kTargetValidityHit) + GetCounter(Counter::kTargetValidityMiss);
+			if (validityLookups > 0) {
+				logger::info("  Target validity cache hit rate {:.1f}%", 100.0 * GetCounter(Counter::kTargetValidityHit) / validityLookups);
+			}
+		}
+	}
+
+	void AddTime(Phase a_phase, std::chrono::nanoseconds a_duration)
+	{
+		phaseStats[static_cast<std::size_t>(a_phase)].current.fetch_add(a_duration.count(), std::memory_order_relaxed);
+	}
+
+	void AddCount(Counter a_counter, std::uint32_t a_amount)
+	{
+		counters[static_cast<std::size_t>(a_counter)].fetch_add(a_amount, std::memory_order_relaxed);
+	}
+
+	void EndFrame()
+	{
+		for (auto& stats : phaseStats) {
+			const std::chrono::nanoseconds current{ stats.current.exchange(0, std::memory_order_relaxed) };
+			stats.total += current;
+			stats.max = std::max(stats.max, current);
+		}
+
+		if (++frameCount >= reportInterval) {
+			Report();
+			for (auto& stats : phaseStats) {
+				stats.total = std::chrono::nanoseconds::zero();
+				stats.max = std::chrono::nanoseconds::zero();
+			}
+			for (auto& counter : counters) {
+				counter.store(0, std::memory_order_relaxed);
+			}
+			frameCount = 0;
+		}
+	}
+}
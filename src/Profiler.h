@@ -0,0 +1,117 @@
+#pragma once
+
+// Lightweight wall time profiling and event counting of the main update loop. Compiled out unless the plugin is built with ENABLE_PROFILING.
+namespace Profiler
+{
+#ifdef TDM_PROFILING
+	inline constexpr bool bEnabled = true;
+#else
+	inline constexpr bool bEnabled = false;
+#endif
+
+	enum class Phase : std::uint32_t
+	{
+		kUpdate,
+		kSolveLeaning,
+		kUpdateGlobals,
+		kProgressTimers,
+		kUpdateTargetLock,
+		kUpdateTargetSwitchGraphs,
+		kUpdateTweeningState,
+		kUpdateFacingState,
+		kUpdateFacingCrosshair,
+		kUpdateDirectionalMovement,
+		kUpdateDodgingState,
+		kUpdateJumpingState,
+		kUpdateMountedArchery,
+		kUpdateTargetFacing,
+		kUpdateRotation,
+		kUpdateRotationLockedCam,
+		kUpdateCameraAutoRotation,
+		kUpdateCameraReset,
+		kUpdateProjectileTargetMap,
+		kUpdateProjectileGuidance,
+
+		kTotal
+	};
+
+	enum class Counter : std::uint32_t
+	{
+		kTargetValidityHit,
+		kTargetValidityMiss,
+		kLineOfSightSaved,
+		kLineOfSightTested,
+		kLineOfSightDeferred,
+		kAimPredictionSolved,
+		kAimPredictionReused,
+		kGraphVariableWriteIssued,
+		kGraphVariableWriteSuppressed,
+		kLeaningSolved,
+		kLeaningSkipped,
+
+		kTotal
+	};
+
+	void AddTime(Phase a_phase, std::chrono::nanoseconds a_duration);
+	void AddCount(Counter a_counter, std::uint32_t a_amount);
+	void EndFrame();
+
+	inline void Count(Counter a_counter, std::uint32_t a_amount = 1)
+	{
+		if constexpr (bEnabled) {
+			AddCount(a_counter, a_amount);
+		}
+	}
+
+	class ScopedPhase
+	{
+	public:
+		explicit ScopedPhase(Phase a_phase) :
+			_phase(a_phase)
+		{
+			if constexpr (bEnabled) {
+				_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~ScopedPhase()
+		{
+			if constexpr (bEnabled) {
+				AddTime(_phase, std::chrono::steady_clock::now() - _start);
+			}
+		}
+
+		ScopedPhase(const ScopedPhase&) = delete;
+		ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	private:
+		Phase _phase;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	// Measures the whole update and closes the frame when it goes out of scope
+	class ScopedFrame
+	{
+	public:
+		ScopedFrame()
+		{
+			if constexpr (bEnabled) {
+				_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~ScopedFrame()
+		{
+			if constexpr (bEnabled) {
+				AddTime(Phase::kUpdate, std::chrono::steady_clock::now() - _start);
+				EndFrame();
+			}
+		}
+
+		ScopedFrame(const ScopedFrame&) = delete;
+		ScopedFrame& operator=(const ScopedFrame&) = delete;
+
+	private:
+		std::chrono::steady_clock::time_point _start;
+	};
+}
@@ -0,0 +1,67 @@
+#include "ProjectileGuidance.h"
+#include "MathUtils.h"
+
+void ProjectileGuidance::Compute(const RE::NiPoint3& a_location, const RE::NiPoint3& a_targetPosition)
+{
+	direction = a_targetPosition - a_location;
+
+	// normalize direction
+	direction.Unitize();
+
+	// rotate
+	const auto orientation = GetProjectileOrientation(direction);
+	pitch = orientation.pitch;
+	yaw = orientation.yaw;
+	rotation = orientation.rotation;
+}
+
+void ProjectileGuidance::Apply(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode) const
+{
+	auto& linearVelocity = a_projectile->GetProjectileRuntimeData().linearVelocity;
+	float speed = linearVelocity.Length();
+
+	a_projectile->data.angle.x = pitch;
+	a_projectile->data.angle.z = yaw;
+	a_projectileNode->local.rotate = rotation;
+	linearVelocity = direction * speed;
+}
+
+void ProjectileGuidance::Navigate(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode, const RE::NiPoint3& a_targetPosition, float a_deltaTime, float a_navigationConstant, float a_maxTurnRate)
+{
+	RE::NiPoint3 currentLineOfSight = a_targetPosition - a_projectile->data.location;
+	if (currentLineOfSight.Unitize() <= 0.f) {
+		return;
+	}
+
+	auto& linearVelocity = a_projectile->GetProjectileRuntimeData().linearVelocity;
+
+	if (bHasLineOfSight && a_deltaTime > 0.f) {
+		// turn the velocity around the axis the line of sight rotated around since the last update, N times as far, capped by the turn rate.
+		// A rotation keeps the speed, no renormalization needed
+		RE::NiPoint3 axis = lineOfSight.Cross(currentLineOfSight);
+		const float sinAngle = axis.Unitize();
+		if (sinAngle > 0.f) {
+			const float lineOfSightAngle = FastAtan2(sinAngle, lineOfSight.Dot(currentLineOfSight));
+			const float turnAngle = std::min(a_navigationConstant * lineOfSightAngle, a_maxTurnRate * a_deltaTime);
+			linearVelocity = RotateAngleAxis(linearVelocity, turnAngle, axis);
+		}
+	}
+
+	lineOfSight = currentLineOfSight;
+	bHasLineOfSight = true;
+
+	direction = linearVelocity;
+	if (direction.Unitize() <= 0.f) {
+		return;
+	}
+
+	// rotate
+	const auto orientation = GetProjectileOrientation(direction);
+	pitch = orientation.pitch;
+	yaw = orientation.yaw;
+	rotation = orientation.rotation;
+
+	a_projectile->data.angle.x = pitch;
+	a_projectile->data.angle.z = yaw;
+	a_projectileNode->local.rotate = rotation;
+}
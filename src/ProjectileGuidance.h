@@ -0,0 +1,24 @@
+#pragma once
+
+// Homing steering of a lock-on projectile towards its target point. Computed either right in the projectile's update, or for all
+// tracked projectiles at once on the first projectile update of a frame and applied later, with the exact same math.
+// Proportional navigation instead turns the velocity by a multiple of the line of sight rotation, which needs the last line of sight.
+struct ProjectileGuidance
+{
+	static constexpr std::uint32_t invalidFrame = std::numeric_limits<std::uint32_t>::max();
+
+	RE::NiPoint3 direction;
+	float pitch = 0.f;
+	float yaw = 0.f;
+	RE::NiMatrix3 rotation;
+	std::uint32_t frame = invalidFrame;
+
+	RE::NiPoint3 lineOfSight;
+	bool bHasLineOfSight = false;
+
+	void Compute(const RE::NiPoint3& a_location, const RE::NiPoint3& a_targetPosition);
+	void Apply(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode) const;
+
+	// a_deltaTime is the step the projectile moves with this update, the turn is capped at a_maxTurnRate (radians per second) over it
+	void Navigate(RE::Projectile* a_projectile, RE::NiAVObject* a_projectileNode, const RE::NiPoint3& a_targetPosition, float a_deltaTime, float a_navigationConstant, float a_maxTurnRate);
+};
@@ -0,0 +1,132 @@
+#include "ProjectileTargetTable.h"
+
+RE::NiAVObject* ProjectileTargetTable::Find(RE::ObjectRefHandle a_projectileHandle) const
+{
+	const auto slot = FindSlot(GetKey(a_projectileHandle));
+	return slot >= 0 ? _slots[slot].targetPoint.get() : nullptr;
+}
+
+ProjectileGuidance* ProjectileTargetTable::FindGuidance(RE::ObjectRefHandle a_projectileHandle, RE::NiAVObject** a_outTargetPoint)
+{
+	const auto slot = FindSlot(GetKey(a_projectileHandle));
+	if (slot < 0) {
+		return nullptr;
+	}
+
+	auto& entry = _slots[slot];
+	if (a_outTargetPoint) {
+		*a_outTargetPoint = entry.targetPoint.get();
+	}
+	return std::addressof(entry.guidance);
+}
+
+bool ProjectileTargetTable::Insert(RE::ObjectRefHandle a_projectileHandle, RE::NiPointer<RE::NiAVObject> a_targetPoint)
+{
+	const auto key = GetKey(a_projectileHandle);
+	if (key == 0) {
+		return false;
+	}
+
+	if (_size >= _maxLoad) {
+		ExpireAll();
+		if (_size >= _maxLoad) {
+			return false;
+		}
+	}
+
+	for (auto slot = GetHomeSlot(key);; slot = GetNextSlot(slot)) {
+		auto& entry = _slots[slot];
+		if (entry.key == key) {
+			return false;  // already tracked, keep the original target point
+		}
+		if (entry.key == 0) {
+			entry.key = key;
+			entry.handle = a_projectileHandle;
+			entry.targetPoint = std::move(a_targetPoint);
+			entry.guidance = ProjectileGuidance{};
+			++_size;
+			return true;
+		}
+	}
+}
+
+void ProjectileTargetTable::Erase(RE::ObjectRefHandle a_projectileHandle)
+{
+	const auto slot = FindSlot(GetKey(a_projectileHandle));
+	if (slot >= 0) {
+		EraseSlot(static_cast<std::uint32_t>(slot));
+	}
+}
+
+void ProjectileTargetTable::Expire(std::uint32_t a_maxSlots)
+{
+	if (_size == 0) {
+		return;
+	}
+
+	const auto maxSlots = std::min(a_maxSlots, _capacity);
+	std::uint32_t checked = 0;
+	while (checked < maxSlots && _size > 0) {
+		auto& entry = _slots[_expireCursor];
+		if (entry.key != 0 && !entry.handle) {
+			// the next entry of the cluster may get shifted into this slot, look at it again
+			EraseSlot(_expireCursor);
+			continue;
+		}
+		_expireCursor = GetNextSlot(_expireCursor);
+		++checked;
+	}
+}
+
+void ProjectileTargetTable::Clear()
+{
+	_slots.fill(Slot{});
+	_size = 0;
+	_expireCursor = 0;
+}
+
+std::int32_t ProjectileTargetTable::FindSlot(std::uint32_t a_key) const
+{
+	if (a_key == 0 || _size == 0) {
+		return -1;
+	}
+
+	for (auto slot = GetHomeSlot(a_key);; slot = GetNextSlot(slot)) {
+		const auto& entry = _slots[slot];
+		if (entry.key == a_key) {
+			return static_cast<std::int32_t>(slot);
+		}
+		if (entry.key == 0) {
+			return -1;
+		}
+	}
+}
+
+void ProjectileTargetTable::EraseSlot(std::uint32_t a_slot)
+{
+	// backward shift deletion, keeps probe sequences intact without tombstones
+	auto hole = a_slot;
+	for (auto slot = GetNextSlot(hole);; slot = GetNextSlot(slot)) {
+		auto& entry = _slots[slot];
+		if (entry.key == 0) {
+			break;
+		}
+
+		// move the entry into the hole unless its home slot lies cyclically in (hole, slot]
+		const auto home = GetHomeSlot(entry.key);
+		const bool bHomeInRange = hole <= slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+		if (!bHomeInRange) {
+			_slots[hole] = std::move(entry);
+			entry = Slot{};
+			hole = slot;
+		}
+	}
+
+	_slots[hole] = Slot{};
+	--_size;
+}
+
+void ProjectileTargetTable::ExpireAll()
+{
+	Expire(_capacity);
+}
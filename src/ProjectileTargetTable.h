@@ -0,0 +1,59 @@
+#pragma once
+#include "ProjectileGuidance.h"
+
+// Fixed capacity open addressing table of projectile -> target point, keyed by native handle. The handle's age bits act as a
+// generation check, so a reused reference slot never matches a stale entry. Dead projectiles are expired a few slots per frame
+// instead of sweeping the whole table, and lazily whenever an insert needs room.
+class ProjectileTargetTable
+{
+public:
+	RE::NiAVObject* Find(RE::ObjectRefHandle a_projectileHandle) const;
+	ProjectileGuidance* FindGuidance(RE::ObjectRefHandle a_projectileHandle, RE::NiAVObject** a_outTargetPoint = nullptr);
+	bool Insert(RE::ObjectRefHandle a_projectileHandle, RE::NiPointer<RE::NiAVObject> a_targetPoint);
+	void Erase(RE::ObjectRefHandle a_projectileHandle);
+
+	void Expire(std::uint32_t a_maxSlots);
+	void Clear();
+
+	[[nodiscard]] bool IsEmpty() const { return _size == 0; }
+	[[nodiscard]] std::uint32_t GetSize() const { return _size; }
+
+	// calls a_func(handle, targetPoint, guidance) for every tracked projectile
+	template <class Func>
+	void ForEach(Func&& a_func)
+	{
+		if (_size == 0) {
+			return;
+		}
+
+		for (auto& slot : _slots) {
+			if (slot.key != 0) {
+				a_func(slot.handle, slot.targetPoint.get(), slot.guidance);
+			}
+		}
+	}
+
+private:
+	struct Slot
+	{
+		std::uint32_t key = 0;  // native handle, 0 marks an empty slot
+		RE::ObjectRefHandle handle;
+		RE::NiPointer<RE::NiAVObject> targetPoint;
+		ProjectileGuidance guidance;
+	};
+
+	static constexpr std::uint32_t _capacity = 1024;  // power of two
+	static constexpr std::uint32_t _maxLoad = _capacity * 3 / 4;
+
+	[[nodiscard]] static std::uint32_t GetKey(RE::ObjectRefHandle a_handle) { return a_handle.native_handle(); }
+	[[nodiscard]] static std::uint32_t GetHomeSlot(std::uint32_t a_key) { return (a_key * 0x9E3779B1u) >> (32 - std::countr_zero(_capacity)); }  // fibonacci hashing
+	[[nodiscard]] static std::uint32_t GetNextSlot(std::uint32_t a_slot) { return (a_slot + 1) & (_capacity - 1); }
+
+	[[nodiscard]] std::int32_t FindSlot(std::uint32_t a_key) const;
+	void EraseSlot(std::uint32_t a_slot);
+	void ExpireAll();
+
+	std::array<Slot, _capacity> _slots{};
+	std::uint32_t _size = 0;
+	std::uint32_t _expireCursor = 0;
+};
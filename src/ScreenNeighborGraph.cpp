@@ -0,0 +1,71 @@
+#include "ScreenNeighborGraph.h"
+
+void ScreenNeighborGraph::Clear()
+{
+	_nodes.clear();
+}
+
+std::uint32_t ScreenNeighborGraph::AddNode(const RE::NiPoint2& a_screenPosition, bool a_bOnScreen)
+{
+	_nodes.push_back({ a_screenPosition, a_bOnScreen });
+
+	return static_cast<std::uint32_t>(_nodes.size() - 1);
+}
+
+std::uint32_t ScreenNeighborGraph::FindNeighbor(std::uint32_t a_node, Direction a_direction) const
+{
+	constexpr std::array<RE::NiPoint2, static_cast<std::size_t>(Direction::kTotal)> directionVectors{
+		RE::NiPoint2{ -1.f, 0.f },
+		RE::NiPoint2{ 1.f, 0.f },
+		RE::NiPoint2{ 0.f, 1.f },
+		RE::NiPoint2{ 0.f, -1.f }
+	};
+
+	if (a_node >= _nodes.size() || a_direction >= Direction::kTotal) {
+		return kInvalid;
+	}
+
+	const auto& node = _nodes[a_node];
+	const auto& directionVector = directionVectors[static_cast<std::size_t>(a_direction)];
+
+	float bestScreenDistance = FLT_MAX;
+	std::uint32_t neighbor = kInvalid;
+	for (std::uint32_t i = 0; i < _nodes.size(); ++i) {
+		auto& other = _nodes[i];
+		if (i == a_node || !other.bOnScreen) {
+			continue;
+		}
+
+		bool bIsCorrectDirection = false;
+		switch (a_direction) {
+		case Direction::kLeft:
+			bIsCorrectDirection = other.screenPosition.x < node.screenPosition.x;
+			break;
+		case Direction::kRight:
+			bIsCorrectDirection = other.screenPosition.x > node.screenPosition.x;
+			break;
+		case Direction::kUp:
+			bIsCorrectDirection = other.screenPosition.y > node.screenPosition.y;
+			break;
+		case Direction::kDown:
+			bIsCorrectDirection = other.screenPosition.y < node.screenPosition.y;
+			break;
+		default:
+			break;
+		}
+
+		if (!bIsCorrectDirection) {
+			continue;
+		}
+
+		RE::NiPoint2 distanceVector = other.screenPosition - node.screenPosition;
+		const float screenDistance = distanceVector.Unitize();
+		const float directionMult = 2.f - directionVector.Dot(distanceVector);  // so targets that are closer to the desired direction are given better score than closer targets that aren't really in that direction
+		if (screenDistance * directionMult < bestScreenDistance) {
+			bestScreenDistance = screenDistance;  // kept as the unweighted distance, like the fallback scans in DirectionalMovementHandler
+			neighbor = i;
+		}
+	}
+
+	return neighbor;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Screen-space nodes gathered when the player switches targets. The neighbor in a direction is found with one scan from the current node,
+// nothing is linked ahead of an input that may never come.
+class ScreenNeighborGraph
+{
+public:
+	enum class Direction : std::uint32_t
+	{
+		kLeft,
+		kRight,
+		kUp,
+		kDown,
+
+		kTotal
+	};
+
+	static constexpr std::uint32_t kInvalid = static_cast<std::uint32_t>(-1);
+
+	void Clear();
+
+	// nodes that aren't on screen can be switched from, but are never a neighbor
+	std::uint32_t AddNode(const RE::NiPoint2& a_screenPosition, bool a_bOnScreen);
+
+	// the best node in a_direction of a_node, ties go to the node added first
+	[[nodiscard]] std::uint32_t FindNeighbor(std::uint32_t a_node, Direction a_direction) const;
+	[[nodiscard]] std::uint32_t GetSize() const { return static_cast<std::uint32_t>(_nodes.size()); }
+
+private:
+	struct Node
+	{
+		RE::NiPoint2 screenPosition;
+		bool bOnScreen;
+	};
+
+	std::vector<Node> _nodes;
+};
@@ -2,6 +2,7 @@
 #include <toml++/toml.h>
 
 #include "DirectionalMovementHandler.h"
+#include "Profiler.h"
 
 void Settings::Initialize()
 {
@@ -35,6 +36,8 @@ void Settings::ReadSettings()
 
 	auto dataHandler = RE::TESDataHandler::GetSingleton();
 
+	std::unordered_map<RE::BGSBodyPartData*, std::vector<std::string>> tomlTargetPoints;
+
 	const auto readToml = [&](std::filesystem::path path) {
 		logger::info("  Reading {}...", path.string());
 		try {
@@ -53,7 +56,7 @@ void Settings::ReadSettings()
 							bones.push_back(*boneName.value<std::string>());
 						}
 
-						targetPoints.insert_or_assign(bodyPartData, bones);
+						tomlTargetPoints.insert_or_assign(bodyPartData, bones);
 					}	
 				}							
 			}
@@ -83,6 +86,16 @@ void Settings::ReadSettings()
 		}
 	}
 
+	targetPointNames.clear();
+	targetPoints.clear();
+	for (auto& [bodyPartData, bones] : tomlTargetPoints) {
+		const auto begin = static_cast<std::uint32_t>(targetPointNames.size());
+		for (auto& bone : bones) {
+			targetPointNames.emplace_back(bone);
+		}
+		targetPoints.emplace(bodyPartData, TargetPointRange{ begin, static_cast<std::uint32_t>(bones.size()) });
+	}
+
 	logger::info("...success");
 
 	const auto readMCM = [&](std::filesystem::path path) {
@@ -126,6 +139,10 @@ void Settings::ReadSettings()
 		ReadFloatSetting(mcm, "Leaning", "fLeaningMult", fLeaningMult);
 		ReadFloatSetting(mcm, "Leaning", "fLeaningSpeed", fLeaningSpeed);
 		ReadFloatSetting(mcm, "Leaning", "fMaxLeaningStrength", fMaxLeaningStrength);
+		ReadBoolSetting(mcm, "Leaning", "bEnableLeaningLOD", bEnableLeaningLOD);
+		ReadFloatSetting(mcm, "Leaning", "fLeaningLODFullRateDistance", fLeaningLODFullRateDistance);
+		ReadFloatSetting(mcm, "Leaning", "fLeaningLODMaxDistance", fLeaningLODMaxDistance);
+		ReadUInt32Setting(mcm, "Leaning", "uLeaningLODInterval", uLeaningLODInterval);
 
 		// Headtracking
 		ReadBoolSetting(mcm, "Headtracking", "bHeadtracking", bHeadtracking);
@@ -150,6 +167,13 @@ void Settings::ReadSettings()
 		ReadFloatSetting(mcm, "TargetLock", "fTargetLockPitchOffsetStrength", fTargetLockPitchOffsetStrength);
 		ReadUInt32Setting(mcm, "TargetLock", "uTargetLockArrowAimType", (uint32_t&)uTargetLockArrowAimType);
 		ReadUInt32Setting(mcm, "TargetLock", "uTargetLockMissileAimType", (uint32_t&)uTargetLockMissileAimType);
+		ReadBoolSetting(mcm, "TargetLock", "bTargetLockBatchedProjectileGuidance", bTargetLockBatchedProjectileGuidance);
+		ReadUInt32Setting(mcm, "TargetLock", "uTargetLockPredictionSolver", (uint32_t&)uTargetLockPredictionSolver);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockProjectileDrag", fTargetLockProjectileDrag);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockNavigationConstant", fTargetLockNavigationConstant);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockNavigationMaxTurnRate", fTargetLockNavigationMaxTurnRate);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockVelocityFilterAlpha", fTargetLockVelocityFilterAlpha);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockVelocityFilterBeta", fTargetLockVelocityFilterBeta);
 		ReadBoolSetting(mcm, "TargetLock", "bTargetLockUsePOVSwitchKeyboard", bTargetLockUsePOVSwitchKeyboard);
 		ReadBoolSetting(mcm, "TargetLock", "bTargetLockUsePOVSwitchGamepad", bTargetLockUsePOVSwitchGamepad);
 		ReadFloatSetting(mcm, "TargetLock", "fTargetLockPOVHoldDuration", fTargetLockPOVHoldDuration);
@@ -159,6 +183,13 @@ void Settings::ReadSettings()
 		ReadBoolSetting(mcm, "TargetLock", "bTargetLockUseRightThumbstick", bTargetLockUseRightThumbstick);
 		ReadBoolSetting(mcm, "TargetLock", "bResetCameraWithTargetLock", bResetCameraWithTargetLock);
 		ReadBoolSetting(mcm, "TargetLock", "bResetCameraPitch", bResetCameraPitch);
+		ReadUInt32Setting(mcm, "TargetLock", "uTargetLockLOSBudget", uTargetLockLOSBudget);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockLOSBudgetTime", fTargetLockLOSBudgetTime);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockLOSFreshness", fTargetLockLOSFreshness);
+		ReadBoolSetting(mcm, "TargetLock", "bTargetLockWeightedSelection", bTargetLockWeightedSelection);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockWeightDistance", fTargetLockWeightDistance);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockWeightAngle", fTargetLockWeightAngle);
+		ReadFloatSetting(mcm, "TargetLock", "fTargetLockWeightHostility", fTargetLockWeightHostility);
 
 		// HUD
 		ReadBoolSetting(mcm, "HUD", "bEnableTargetLockReticle", bEnableTargetLockReticle);
@@ -195,6 +226,16 @@ void Settings::ReadSettings()
 	DirectionalMovementHandler::GetSingleton()->OnSettingsUpdated();
 }
 
+std::optional<std::span<const RE::BSFixedString>> Settings::GetTargetPoints(RE::BGSBodyPartData* a_bodyPartData)
+{
+	auto it = targetPoints.find(a_bodyPartData);
+	if (it == targetPoints.end()) {
+		return std::nullopt;
+	}
+
+	return std::span<const RE::BSFixedString>{ targetPointNames.data() + it->second.begin, it->second.count };
+}
+
 void Settings::OnPostLoadGame()
 {
 	UpdateGlobals();
@@ -202,6 +243,8 @@ void Settings::OnPostLoadGame()
 
 void Settings::UpdateGlobals()
 {
+	Profiler::ScopedPhase profilePhase{ Profiler::Phase::kUpdateGlobals };
+
 	if (glob_trueHUD) {
 		glob_trueHUD->value = DirectionalMovementHandler::GetSingleton()->g_trueHUD != nullptr ? 1.f : 0.f;
 	}
@@ -11,7 +11,14 @@ enum TargetLockProjectileAimType : std::uint32_t
 {
 	kFreeAim = 0,
 	kPredict = 1,
-	kHoming = 2
+	kHoming = 2,
+	kProportionalNavigation = 3
+};
+
+enum class ProjectilePredictionSolver : std::uint32_t
+{
+	kQuadratic = 0,
+	kIterative = 1
 };
 
 enum class DialogueMode : std::uint32_t
@@ -53,6 +60,7 @@ struct Settings
 {
 	static void Initialize();
 	static void ReadSettings();
+	static std::optional<std::span<const RE::BSFixedString>> GetTargetPoints(RE::BGSBodyPartData* a_bodyPartData);
 	static void OnPostLoadGame();
 	static void UpdateGlobals();
 
@@ -95,6 +103,10 @@ struct Settings
 	static inline float fLeaningMult = 2.f;
 	static inline float fLeaningSpeed = 4.f;
 	static inline float fMaxLeaningStrength = 10.f;
+	static inline bool bEnableLeaningLOD = false;
+	static inline float fLeaningLODFullRateDistance = 1500.f;
+	static inline float fLeaningLODMaxDistance = 4000.f;
+	static inline uint32_t uLeaningLODInterval = 3;
 
 	// Headtracking
 	static inline bool bHeadtracking = true;
@@ -120,6 +132,13 @@ struct Settings
 	static inline float fTargetLockPitchOffsetStrength = 0.25f;
 	static inline TargetLockProjectileAimType uTargetLockArrowAimType = TargetLockProjectileAimType::kPredict;
 	static inline TargetLockProjectileAimType uTargetLockMissileAimType = TargetLockProjectileAimType::kPredict;
+	static inline bool bTargetLockBatchedProjectileGuidance = false;
+	static inline ProjectilePredictionSolver uTargetLockPredictionSolver = ProjectilePredictionSolver::kQuadratic;
+	static inline float fTargetLockNavigationConstant = 4.f;
+	static inline float fTargetLockNavigationMaxTurnRate = 180.f;
+	static inline float fTargetLockVelocityFilterAlpha = 0.5f;
+	static inline float fTargetLockVelocityFilterBeta = 0.1f;
+	static inline float fTargetLockProjectileDrag = 0.f;
 	static inline bool bTargetLockUsePOVSwitchKeyboard = false;
 	static inline bool bTargetLockUsePOVSwitchGamepad = true;
 	static inline float fTargetLockPOVHoldDuration = 0.25f;
@@ -129,6 +148,13 @@ struct Settings
 	static inline bool bTargetLockUseRightThumbstick = true;
 	static inline bool bResetCameraWithTargetLock = true;
 	static inline bool bResetCameraPitch = false;
+	static inline uint32_t uTargetLockLOSBudget = 8;
+	static inline float fTargetLockLOSBudgetTime = 0.f;
+	static inline float fTargetLockLOSFreshness = 0.1f;
+	static inline bool bTargetLockWeightedSelection = false;
+	static inline float fTargetLockWeightDistance = 1.f;
+	static inline float fTargetLockWeightAngle = 1.f;
+	static inline float fTargetLockWeightHostility = 0.5f;
 
 	// HUD
 	static inline bool bEnableTargetLockReticle = true;
@@ -155,7 +181,15 @@ struct Settings
 	static inline uint32_t uSwitchTargetRightKey = static_cast<uint32_t>(-1);
 
 	// Non-MCM
-	static inline std::unordered_map<RE::BGSBodyPartData*, std::vector<std::string>> targetPoints;
+	struct TargetPointRange
+	{
+		std::uint32_t begin;
+		std::uint32_t count;
+	};
+
+	// target point bone names of all body part records, interned once when the .toml files are read
+	static inline std::vector<RE::BSFixedString> targetPointNames;
+	static inline std::unordered_map<RE::BGSBodyPartData*, TargetPointRange> targetPoints;
 
 	static inline RE::BGSKeyword* kywd_magicWard = nullptr;
 	static inline RE::BGSKeyword* kywd_furnitureForces1stPerson = nullptr;
@@ -0,0 +1,34 @@
+#pragma once
+
+// The bones of one loaded 3D root as BoneCache keeps them, by interned name. A bone that isn't found is only remembered as missing for a
+// while, nodes attached later (weapons, armor addons) have to be picked up by a later lookup.
+class SkeletonBones
+{
+public:
+	static constexpr std::uint32_t maxMissAge = 60;  // frames before a missing bone is looked up again
+
+	// the cached node of a_name, looked up with a_lookup(a_name) on first use and again once a miss is too old
+	template <class Lookup>
+	RE::NiAVObject* Find(const char* a_name, std::uint32_t a_frame, Lookup&& a_lookup)
+	{
+		auto [it, bInserted] = _bones.try_emplace(a_name);
+		auto& bone = it->second;
+		if (bInserted || (!bone.node && a_frame - bone.lookupFrame > maxMissAge)) {
+			bone.node.reset(a_lookup(a_name));
+			bone.lookupFrame = a_frame;
+		}
+
+		return bone.node.get();
+	}
+
+	[[nodiscard]] std::size_t GetSize() const { return _bones.size(); }
+
+private:
+	struct Bone
+	{
+		RE::NiPointer<RE::NiAVObject> node;
+		std::uint32_t lookupFrame = 0;
+	};
+
+	std::unordered_map<const char*, Bone> _bones;  // keyed by the interned string
+};
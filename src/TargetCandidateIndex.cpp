@@ -0,0 +1,53 @@
+#include "TargetCandidateIndex.h"
+
+void TargetCandidateIndex::Clear()
+{
+	_candidates.clear();
+	_order.clear();
+	_cellKeys.clear();
+	_bucketStarts.clear();
+	_maxDistance = 0.f;
+	_bLinearScan = true;
+}
+
+void TargetCandidateIndex::Insert(TargetCandidate&& a_candidate)
+{
+	_maxDistance = std::max(_maxDistance, a_candidate.maxDistance);
+	_candidates.push_back(std::move(a_candidate));
+}
+
+void TargetCandidateIndex::Build(std::size_t a_gridThreshold /*= gridThreshold*/)
+{
+	_order.clear();
+	_cellKeys.clear();
+	_bucketStarts.clear();
+
+	_bLinearScan = _candidates.size() < a_gridThreshold || _candidates.empty();
+	if (_bLinearScan) {
+		return;
+	}
+
+	const auto bucketCount = static_cast<std::uint32_t>(std::bit_ceil(_candidates.size()));
+	_bucketMask = bucketCount - 1;
+
+	// counting sort of the indices by bucket, so every bucket is a contiguous range
+	_unsortedCellKeys.clear();
+	_bucketStarts.assign(bucketCount + 1, 0);
+	for (const auto& candidate : _candidates) {
+		const auto key = GetCellKey(GetCellCoord(candidate.position.x), GetCellCoord(candidate.position.y));
+		_unsortedCellKeys.push_back(key);
+		++_bucketStarts[GetBucket(key) + 1];
+	}
+	std::partial_sum(_bucketStarts.begin(), _bucketStarts.end(), _bucketStarts.begin());
+
+	// every index goes to the next free slot of its bucket, which leaves each bucket's start at the next one's, shifted back below
+	_order.resize(_candidates.size());
+	_cellKeys.resize(_candidates.size());
+	for (std::uint32_t i = 0; i < _candidates.size(); ++i) {
+		const auto slot = _bucketStarts[GetBucket(_unsortedCellKeys[i])]++;
+		_order[slot] = i;
+		_cellKeys[slot] = _unsortedCellKeys[i];
+	}
+	std::shift_right(_bucketStarts.begin(), _bucketStarts.end(), 1);
+	_bucketStarts[0] = 0;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "MathUtils.h"
+
+// A lock-on candidate gathered once per frame from the high process actor list
+struct TargetCandidate
+{
+	RE::ActorHandle handle;
+	RE::ActorPtr actor;
+	RE::NiPoint3 position;  // actor root position
+	float maxDistance = 0.f;  // target lock distance, scaled by race size
+
+	// resolved lazily, only the consumers that care about target points pay for the bone lookup
+	bool bTargetPointResolved = false;
+	RE::NiPointer<RE::NiAVObject> targetPoint;
+	RE::NiPoint3 targetPosition;
+};
+
+// Uniform grid over the XY plane, hashed into as many buckets as there are candidates so it builds in linear time. Queries are a broad
+// phase on the actor root position, callers do their own exact tests. Small candidate sets skip the grid and are scanned linearly.
+class TargetCandidateIndex
+{
+public:
+	// the candidate count from which a frame's build and queries are cheaper through the grid. The TargetCandidateIndexQuery benchmark
+	// finds none up to 5000 candidates: the build costs about as much as ten linear scans and a frame makes three queries.
+	static constexpr std::size_t gridThreshold = std::numeric_limits<std::size_t>::max();
+
+	void Clear();
+	void Insert(TargetCandidate&& a_candidate);
+	void Build(std::size_t a_gridThreshold = gridThreshold);
+
+	[[nodiscard]] bool IsEmpty() const { return _candidates.empty(); }
+	[[nodiscard]] std::size_t GetSize() const { return _candidates.size(); }
+	[[nodiscard]] float GetMaxDistance() const { return _maxDistance; }
+
+	// calls a_func for every candidate whose root lies within a_radius of a_origin
+	template <class Func>
+	void ForEachInRadius(const RE::NiPoint3& a_origin, float a_radius, Func&& a_func)
+	{
+		const float radiusSquared = a_radius * a_radius;
+		ForEachInCells(a_origin, a_radius, [&](TargetCandidate& a_candidate) {
+			const float dx = a_candidate.position.x - a_origin.x;
+			const float dy = a_candidate.position.y - a_origin.y;
+			if (dx * dx + dy * dy <= radiusSquared) {
+				a_func(a_candidate);
+			}
+		});
+	}
+
+	// calls a_func for every candidate whose root lies within a_radius of a_origin and within a_halfAngle of a_direction (unit vector, world XY)
+	template <class Func>
+	void ForEachInCone(const RE::NiPoint3& a_origin, const RE::NiPoint2& a_direction, float a_radius, float a_halfAngle, Func&& a_func)
+	{
+		const float cosHalfAngle = std::cos(std::min(a_halfAngle, PI));
+		ForEachInRadius(a_origin, a_radius, [&](TargetCandidate& a_candidate) {
+			RE::NiPoint2 direction{ a_candidate.position.x - a_origin.x, a_candidate.position.y - a_origin.y };
+			if (direction.Unitize() <= 0.f || direction.Dot(a_direction) >= cosHalfAngle) {
+				a_func(a_candidate);
+			}
+		});
+	}
+
+private:
+	using CellKey = std::uint64_t;
+
+	static constexpr float _cellSize = 1024.f;
+
+	[[nodiscard]] static std::int32_t GetCellCoord(float a_value) { return static_cast<std::int32_t>(std::floor(a_value / _cellSize)); }
+	[[nodiscard]] static CellKey GetCellKey(std::int32_t a_x, std::int32_t a_y) { return (static_cast<CellKey>(static_cast<std::uint32_t>(a_x)) << 32) | static_cast<std::uint32_t>(a_y); }
+	[[nodiscard]] std::uint32_t GetBucket(CellKey a_key) const { return static_cast<std::uint32_t>((a_key * 0x9E3779B97F4A7C15ull) >> 32) & _bucketMask; }
+
+	// calls a_func for every candidate in the cells a_radius around a_origin touches, or for all of them when that's cheaper
+	template <class Func>
+	void ForEachInCells(const RE::NiPoint3& a_origin, float a_radius, Func&& a_func)
+	{
+		const std::int32_t minX = GetCellCoord(a_origin.x - a_radius);
+		const std::int32_t maxX = GetCellCoord(a_origin.x + a_radius);
+		const std::int32_t minY = GetCellCoord(a_origin.y - a_radius);
+		const std::int32_t maxY = GetCellCoord(a_origin.y + a_radius);
+
+		const std::uint64_t cellsCovered = static_cast<std::uint64_t>(maxX - minX + 1) * static_cast<std::uint64_t>(maxY - minY + 1);
+		if (_bLinearScan || cellsCovered >= _candidates.size()) {
+			for (auto& candidate : _candidates) {
+				a_func(candidate);
+			}
+			return;
+		}
+
+		// a bucket may hold other cells too, the stored keys tell them apart so no candidate is visited twice
+		for (std::int32_t x = minX; x <= maxX; ++x) {
+			for (std::int32_t y = minY; y <= maxY; ++y) {
+				const auto key = GetCellKey(x, y);
+				const auto bucket = GetBucket(key);
+				for (auto i = _bucketStarts[bucket]; i < _bucketStarts[bucket + 1]; ++i) {
+					if (_cellKeys[i] == key) {
+						a_func(_candidates[_order[i]]);
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<TargetCandidate> _candidates;  // in insertion order, the grid only orders indices into it
+	std::vector<std::uint32_t> _order;           // candidate indices, in bucket order
+	std::vector<CellKey> _cellKeys;              // the cell of _order[i]
+	std::vector<std::uint32_t> _bucketStarts;    // bucket b is [_bucketStarts[b], _bucketStarts[b + 1]) of _order
+	std::uint32_t _bucketMask = 0;
+	float _maxDistance = 0.f;
+	bool _bLinearScan = true;
+
+	std::vector<CellKey> _unsortedCellKeys;  // scratch for Build, kept for its capacity
+};
@@ -0,0 +1,112 @@
+#include "TargetScoring.h"
+
+#include <xmmintrin.h>
+
+void TargetScoringBatch::Clear()
+{
+	_size = 0;
+	_x.clear();
+	_y.clear();
+	_z.clear();
+	_maxDistance.clear();
+	_hostile.clear();
+	_score.clear();
+	_tieBreak.clear();
+}
+
+void TargetScoringBatch::Add(const RE::NiPoint3& a_position, float a_maxDistance, bool a_bHostile, std::uint32_t a_tieBreak)
+{
+	if (_x.size() != _size) {  // drop the padding of a previous Score
+		_x.resize(_size);
+		_y.resize(_size);
+		_z.resize(_size);
+		_maxDistance.resize(_size);
+		_hostile.resize(_size);
+	}
+
+	_x.push_back(a_position.x);
+	_y.push_back(a_position.y);
+	_z.push_back(a_position.z);
+	_maxDistance.push_back(a_maxDistance);
+	_hostile.push_back(a_bHostile ? 1.f : 0.f);
+	_tieBreak.push_back(a_tieBreak);
+	++_size;
+}
+
+void TargetScoringBatch::Score(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_forward, Mode a_mode, const Weights& a_weights)
+{
+	const std::uint32_t paddedSize = (_size + _laneCount - 1) / _laneCount * _laneCount;
+	_x.resize(paddedSize, a_origin.x);
+	_y.resize(paddedSize, a_origin.y);
+	_z.resize(paddedSize, a_origin.z);
+	_maxDistance.resize(paddedSize, -1.f);
+	_hostile.resize(paddedSize, 0.f);
+	_score.resize(paddedSize);
+
+	const __m128 originX = _mm_set1_ps(a_origin.x);
+	const __m128 originY = _mm_set1_ps(a_origin.y);
+	const __m128 originZ = _mm_set1_ps(a_origin.z);
+	const __m128 forwardX = _mm_set1_ps(a_forward.x);
+	const __m128 forwardY = _mm_set1_ps(a_forward.y);
+	const __m128 forwardZ = _mm_set1_ps(a_forward.z);
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 epsilon = _mm_set1_ps(1e-6f);
+	const __m128 outOfRange = _mm_set1_ps(FLT_MAX);
+	const __m128 distanceWeight = _mm_set1_ps(a_weights.distance);
+	const __m128 angleWeight = _mm_set1_ps(a_weights.angle);
+	const __m128 hostilityWeight = _mm_set1_ps(a_weights.hostility);
+
+	for (std::uint32_t i = 0; i < paddedSize; i += _laneCount) {
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&_x[i]), originX);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&_y[i]), originY);
+		const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&_z[i]), originZ);
+		const __m128 range = _mm_loadu_ps(&_maxDistance[i]);
+
+		const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		// dot of the forward vector and the unit direction to the candidate
+		const __m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, forwardX), _mm_mul_ps(dy, forwardY)), _mm_mul_ps(dz, forwardZ));
+		const __m128 dot = _mm_div_ps(projection, _mm_max_ps(distance, epsilon));
+
+		__m128 result;
+		switch (a_mode) {
+		case Mode::kClosest:
+		default:
+			result = distance;
+			break;
+		case Mode::kCenter:
+			result = _mm_sub_ps(_mm_setzero_ps(), dot);
+			break;
+		case Mode::kCombined:
+			result = _mm_mul_ps(distance, _mm_sub_ps(one, dot));
+			break;
+		case Mode::kWeighted:
+			{
+				// every term is normalized to [0, 1] before weighting
+				const __m128 distanceTerm = _mm_div_ps(distance, _mm_max_ps(range, epsilon));
+				const __m128 angleTerm = _mm_mul_ps(_mm_sub_ps(one, dot), half);
+				const __m128 hostilityTerm = _mm_sub_ps(one, _mm_loadu_ps(&_hostile[i]));
+				result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(distanceTerm, distanceWeight), _mm_mul_ps(angleTerm, angleWeight)), _mm_mul_ps(hostilityTerm, hostilityWeight));
+				break;
+			}
+		}
+
+		const __m128 inRange = _mm_cmple_ps(distance, range);
+		_mm_storeu_ps(&_score[i], _mm_or_ps(_mm_and_ps(inRange, result), _mm_andnot_ps(inRange, outOfRange)));
+	}
+}
+
+void TargetScoringBatch::GetRanking(std::vector<std::uint32_t>& a_outIndices) const
+{
+	a_outIndices.clear();
+	for (std::uint32_t i = 0; i < _size; ++i) {
+		if (_score[i] < FLT_MAX) {
+			a_outIndices.push_back(i);
+		}
+	}
+
+	// the candidates come in grid or actor list order, which changes from frame to frame, so ties go to the lower handle
+	std::sort(a_outIndices.begin(), a_outIndices.end(), [&](std::uint32_t a_lhs, std::uint32_t a_rhs) {
+		return std::tie(_score[a_lhs], _tieBreak[a_lhs], a_lhs) < std::tie(_score[a_rhs], _tieBreak[a_rhs], a_rhs);
+	});
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Structure of arrays batch of lock-on candidates, scored four at a time. Lower scores are better, candidates out of range score FLT_MAX.
+struct TargetScoringBatch
+{
+	enum class Mode : std::uint32_t
+	{
+		kClosest,
+		kCenter,
+		kCombined,
+		kWeighted
+	};
+
+	struct Weights
+	{
+		float distance = 1.f;
+		float angle = 1.f;
+		float hostility = 0.f;
+	};
+
+	void Clear();
+	// equal scores are ranked by a_tieBreak, the actor's native handle, so the choice doesn't depend on the order candidates are gathered in
+	void Add(const RE::NiPoint3& a_position, float a_maxDistance, bool a_bHostile, std::uint32_t a_tieBreak);
+	void Score(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_forward, Mode a_mode, const Weights& a_weights);
+
+	// indices of the candidates in range, best first
+	void GetRanking(std::vector<std::uint32_t>& a_outIndices) const;
+
+	[[nodiscard]] std::uint32_t GetSize() const { return _size; }
+	[[nodiscard]] float GetScore(std::uint32_t a_index) const { return _score[a_index]; }
+
+private:
+	static constexpr std::uint32_t _laneCount = 4;
+
+	std::uint32_t _size = 0;
+
+	// padded to a multiple of the lane count, padding is never in range
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<float> _maxDistance;
+	std::vector<float> _hostile;
+	std::vector<float> _score;
+	std::vector<std::uint32_t> _tieBreak;  // not padded
+};
@@ -0,0 +1,55 @@
+#include "TargetVelocityEstimator.h"
+
+void TargetVelocityEstimator::Update(RE::ActorHandle a_actorHandle, const RE::NiPoint3& a_position, const RE::NiPoint3& a_linearVelocity, std::uint32_t a_frame, float a_deltaTime, float a_alpha, float a_beta)
+{
+	if (!a_actorHandle) {
+		return;
+	}
+
+	const bool bConsecutive = a_frame == _frame + 1;
+	_frame = a_frame;
+
+	if (_sampleCount == 0 || a_actorHandle != _actorHandle || !bConsecutive) {
+		Seed(a_actorHandle, a_position, a_linearVelocity);
+		return;
+	}
+
+	if (a_deltaTime <= 0.f) {
+		return;
+	}
+
+	const RE::NiPoint3 predictedPosition = _position + _velocity * a_deltaTime;
+	const RE::NiPoint3 residual = a_position - predictedPosition;
+	if (residual.Length() > _teleportDistance) {
+		Seed(a_actorHandle, a_position, a_linearVelocity);
+		return;
+	}
+
+	_position = predictedPosition + residual * a_alpha;
+	_velocity += residual * (a_beta / a_deltaTime);
+	++_sampleCount;
+}
+
+void TargetVelocityEstimator::Reset()
+{
+	_actorHandle = RE::ActorHandle();
+	_sampleCount = 0;
+}
+
+bool TargetVelocityEstimator::GetVelocity(RE::ActorHandle a_actorHandle, RE::NiPoint3& a_outVelocity) const
+{
+	if (_sampleCount < _warmupSamples || a_actorHandle != _actorHandle) {
+		return false;
+	}
+
+	a_outVelocity = _velocity;
+	return true;
+}
+
+void TargetVelocityEstimator::Seed(RE::ActorHandle a_actorHandle, const RE::NiPoint3& a_position, const RE::NiPoint3& a_linearVelocity)
+{
+	_actorHandle = a_actorHandle;
+	_position = a_position;
+	_velocity = a_linearVelocity;
+	_sampleCount = 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Alpha-beta filter over the locked target's root position, sampled once per frame. Gives aim prediction a steadier velocity than
+// the instantaneous character controller one, which jitters with locomotion animations, and one estimate shared by every projectile
+// fired in the same frame.
+class TargetVelocityEstimator
+{
+public:
+	// a_linearVelocity is the character controller's, only used to seed the filter. A new actor or a skipped frame starts over, the
+	// position from before the gap would read as a velocity spike.
+	void Update(RE::ActorHandle a_actorHandle, const RE::NiPoint3& a_position, const RE::NiPoint3& a_linearVelocity, std::uint32_t a_frame, float a_deltaTime, float a_alpha, float a_beta);
+	void Reset();
+
+	[[nodiscard]] bool GetVelocity(RE::ActorHandle a_actorHandle, RE::NiPoint3& a_outVelocity) const;
+
+private:
+	static constexpr float _teleportDistance = 1000.f;  // a residual this large is a teleport or a 3D reload, start over
+	static constexpr std::uint32_t _warmupSamples = 3;
+
+	void Seed(RE::ActorHandle a_actorHandle, const RE::NiPoint3& a_position, const RE::NiPoint3& a_linearVelocity);
+
+	RE::ActorHandle _actorHandle;
+	RE::NiPoint3 _position;
+	RE::NiPoint3 _velocity;
+	std::uint32_t _sampleCount = 0;
+	std::uint32_t _frame = 0;
+};
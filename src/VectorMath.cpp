@@ -0,0 +1,69 @@
+#include "VectorMath.h"
+
+namespace VectorMath
+{
+	void WorldPtsToScreenPts3(const float (&a_worldToCamMatrix)[4][4], const RE::NiRect<float>& a_viewPort, std::span<const RE::NiPoint3> a_points, std::span<RE::NiPoint2> a_outScreenPoints, std::span<float> a_outDepths, float a_zeroTolerance /*= 1e-5f*/)
+	{
+		static_assert(sizeof(RE::NiPoint3) == 3 * sizeof(float) && sizeof(RE::NiPoint2) == 2 * sizeof(float));
+		constexpr std::size_t laneCount = 4;
+
+		const auto& m = a_worldToCamMatrix;
+		const float halfWidth = (a_viewPort.right - a_viewPort.left) * 0.5f;
+		const float halfHeight = (a_viewPort.top - a_viewPort.bottom) * 0.5f;
+
+		const __m128 screenScaleX = _mm_set1_ps(halfWidth);
+		const __m128 screenOffsetX = _mm_set1_ps(a_viewPort.left + halfWidth);
+		const __m128 screenScaleY = _mm_set1_ps(halfHeight);
+		const __m128 screenOffsetY = _mm_set1_ps(a_viewPort.bottom + halfHeight);
+		const __m128 zeroTolerance = _mm_set1_ps(a_zeroTolerance);
+		const __m128 behind = _mm_set1_ps(-1.f);
+
+		// one row of the matrix applied to four points
+		auto transform = [&](std::size_t a_row, __m128 a_x, __m128 a_y, __m128 a_z) {
+			const __m128 xy = _mm_add_ps(_mm_mul_ps(a_x, _mm_set1_ps(m[a_row][0])), _mm_mul_ps(a_y, _mm_set1_ps(m[a_row][1])));
+			return _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(a_z, _mm_set1_ps(m[a_row][2]))), _mm_set1_ps(m[a_row][3]));
+		};
+
+		// four packed points in, four packed screen points and depths out
+		auto project = [&](const RE::NiPoint3* a_in, RE::NiPoint2* a_outScreen, float* a_outDepth) {
+			const float* in = &a_in->x;
+			const __m128 a = _mm_loadu_ps(in);      // x0 y0 z0 x1
+			const __m128 b = _mm_loadu_ps(in + 4);  // y1 z1 x2 y2
+			const __m128 c = _mm_loadu_ps(in + 8);  // z2 x3 y3 z3
+
+			const __m128 pointX = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+			const __m128 pointY = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			const __m128 pointZ = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+
+			const __m128 w = transform(3, pointX, pointY, pointZ);
+			const __m128 bInFront = _mm_cmpgt_ps(w, zeroTolerance);
+			const __m128 inverseW = _mm_and_ps(bInFront, _mm_div_ps(_mm_set1_ps(1.f), _mm_max_ps(w, zeroTolerance)));
+
+			const __m128 screenX = _mm_and_ps(bInFront, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(transform(0, pointX, pointY, pointZ), inverseW), screenScaleX), screenOffsetX));
+			const __m128 screenY = _mm_and_ps(bInFront, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(transform(1, pointX, pointY, pointZ), inverseW), screenScaleY), screenOffsetY));
+			const __m128 depth = _mm_mul_ps(transform(2, pointX, pointY, pointZ), inverseW);
+
+			float* outScreen = &a_outScreen->x;
+			_mm_storeu_ps(outScreen, _mm_unpacklo_ps(screenX, screenY));
+			_mm_storeu_ps(outScreen + 4, _mm_unpackhi_ps(screenX, screenY));
+			_mm_storeu_ps(a_outDepth, _mm_or_ps(_mm_and_ps(bInFront, depth), _mm_andnot_ps(bInFront, behind)));
+		};
+
+		const std::size_t count = std::min({ a_points.size(), a_outScreenPoints.size(), a_outDepths.size() });
+		std::size_t i = 0;
+		for (; i + laneCount <= count; i += laneCount) {
+			project(&a_points[i], &a_outScreenPoints[i], &a_outDepths[i]);
+		}
+
+		// the tail goes through a padded copy
+		if (const std::size_t remaining = count - i; remaining > 0) {
+			std::array<RE::NiPoint3, laneCount> points{};
+			std::array<RE::NiPoint2, laneCount> screenPoints;
+			std::array<float, laneCount> depths;
+			std::copy_n(&a_points[i], remaining, points.begin());
+			project(points.data(), screenPoints.data(), depths.data());
+			std::copy_n(screenPoints.begin(), remaining, &a_outScreenPoints[i]);
+			std::copy_n(depths.begin(), remaining, &a_outDepths[i]);
+		}
+	}
+}
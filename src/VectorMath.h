@@ -0,0 +1,119 @@
+#pragma once
+
+#include <emmintrin.h>
+
+// SSE versions of the NiPoint3 math used every frame. A vector is an __m128 with x, y, z in the low lanes, w is ignored by every operation,
+// so an hkVector4 can be used as is. NiPoint3s are loaded and stored in place, without reading or writing past their 12 bytes.
+namespace VectorMath
+{
+	using Vector = __m128;
+
+	[[nodiscard]] inline Vector Load(const float* a_xyz)
+	{
+		const __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(a_xyz)));
+		return _mm_movelh_ps(xy, _mm_load_ss(a_xyz + 2));
+	}
+
+	[[nodiscard]] inline Vector Load(const RE::NiPoint3& a_point) { return Load(&a_point.x); }
+	[[nodiscard]] inline Vector Load(const RE::hkVector4& a_vector) { return a_vector.quad; }
+	[[nodiscard]] inline Vector Set(float a_x, float a_y, float a_z) { return _mm_setr_ps(a_x, a_y, a_z, 0.f); }
+	[[nodiscard]] inline Vector Zero() { return _mm_setzero_ps(); }
+
+	inline void Store(Vector a_vector, RE::NiPoint3& a_outPoint)
+	{
+		_mm_store_sd(reinterpret_cast<double*>(&a_outPoint.x), _mm_castps_pd(a_vector));
+		_mm_store_ss(&a_outPoint.z, _mm_movehl_ps(a_vector, a_vector));
+	}
+
+	[[nodiscard]] inline RE::NiPoint3 ToNiPoint3(Vector a_vector)
+	{
+		RE::NiPoint3 ret;
+		Store(a_vector, ret);
+		return ret;
+	}
+
+	[[nodiscard]] inline float GetX(Vector a_vector) { return _mm_cvtss_f32(a_vector); }
+	[[nodiscard]] inline float GetY(Vector a_vector) { return _mm_cvtss_f32(_mm_shuffle_ps(a_vector, a_vector, _MM_SHUFFLE(1, 1, 1, 1))); }
+	[[nodiscard]] inline float GetZ(Vector a_vector) { return _mm_cvtss_f32(_mm_movehl_ps(a_vector, a_vector)); }
+
+	[[nodiscard]] inline Vector Add(Vector a_lhs, Vector a_rhs) { return _mm_add_ps(a_lhs, a_rhs); }
+	[[nodiscard]] inline Vector Subtract(Vector a_lhs, Vector a_rhs) { return _mm_sub_ps(a_lhs, a_rhs); }
+	[[nodiscard]] inline Vector Scale(Vector a_vector, float a_scale) { return _mm_mul_ps(a_vector, _mm_set1_ps(a_scale)); }
+
+	// zeroes z, for the math that happens on the ground plane
+	[[nodiscard]] inline Vector FlattenZ(Vector a_vector) { return _mm_movelh_ps(a_vector, _mm_setzero_ps()); }
+
+	// result in every lane
+	[[nodiscard]] inline Vector Dot3(Vector a_lhs, Vector a_rhs)
+	{
+		const __m128 product = _mm_mul_ps(a_lhs, a_rhs);
+		const __m128 x = _mm_shuffle_ps(product, product, _MM_SHUFFLE(0, 0, 0, 0));
+		const __m128 y = _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m128 z = _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2));
+		return _mm_add_ps(_mm_add_ps(x, y), z);
+	}
+
+	[[nodiscard]] inline float Dot(Vector a_lhs, Vector a_rhs) { return _mm_cvtss_f32(Dot3(a_lhs, a_rhs)); }
+	[[nodiscard]] inline float LengthSquared(Vector a_vector) { return Dot(a_vector, a_vector); }
+	[[nodiscard]] inline float Length(Vector a_vector) { return _mm_cvtss_f32(_mm_sqrt_ss(Dot3(a_vector, a_vector))); }
+
+	[[nodiscard]] inline Vector Cross(Vector a_lhs, Vector a_rhs)
+	{
+		const __m128 lhsYZX = _mm_shuffle_ps(a_lhs, a_lhs, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 rhsYZX = _mm_shuffle_ps(a_rhs, a_rhs, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 result = _mm_sub_ps(_mm_mul_ps(a_lhs, rhsYZX), _mm_mul_ps(lhsYZX, a_rhs));
+		return _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+
+	// Same contract as NiPoint3::Unitize, vectors no longer than FLT_EPSILON become zero. The reciprocal square root estimate gets one
+	// Newton-Raphson step, which brings it to ~2e-7 relative error, about what the sqrt and divide gave.
+	[[nodiscard]] inline Vector Normalize(Vector a_vector, float* a_outLength = nullptr)
+	{
+		const __m128 lengthSquared = Dot3(a_vector, a_vector);
+		__m128 inverseLength = _mm_rsqrt_ps(lengthSquared);
+		inverseLength = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), inverseLength), _mm_sub_ps(_mm_set1_ps(3.f), _mm_mul_ps(lengthSquared, _mm_mul_ps(inverseLength, inverseLength))));
+
+		const __m128 bValid = _mm_cmpgt_ps(lengthSquared, _mm_set1_ps(FLT_EPSILON * FLT_EPSILON));
+		inverseLength = _mm_and_ps(bValid, inverseLength);
+
+		if (a_outLength) {
+			*a_outLength = _mm_cvtss_f32(_mm_mul_ps(lengthSquared, inverseLength));
+		}
+
+		return _mm_mul_ps(a_vector, inverseLength);
+	}
+
+	// projection of a_vector onto a_onto
+	[[nodiscard]] inline Vector Project(Vector a_vector, Vector a_onto)
+	{
+		return _mm_mul_ps(a_onto, _mm_div_ps(Dot3(a_vector, a_onto), Dot3(a_onto, a_onto)));
+	}
+
+	// same as RotateVector in Utils.h
+	[[nodiscard]] inline Vector Rotate(Vector a_vector, const RE::NiQuaternion& a_quat)
+	{
+		const __m128 q = Load(&a_quat.x);
+		const __m128 t = Cross(q, a_vector);
+		const __m128 t2 = _mm_add_ps(t, t);
+		return _mm_add_ps(_mm_add_ps(a_vector, _mm_mul_ps(t2, _mm_set1_ps(a_quat.w))), Cross(q, t2));
+	}
+
+	// same as ClampSizeMax in Utils.h
+	[[nodiscard]] inline Vector ClampLength(Vector a_vector, float a_max)
+	{
+		if (a_max < 1.e-4f) {
+			return Zero();
+		}
+
+		const float lengthSquared = LengthSquared(a_vector);
+		if (lengthSquared > a_max * a_max) {
+			return Scale(a_vector, a_max / std::sqrt(lengthSquared));
+		}
+
+		return a_vector;
+	}
+
+	// NiCamera::WorldPtToScreenPt3 four points at a time. Points on or behind the camera plane get a depth of -1 and a zero screen position,
+	// so only use this where offscreen points are thrown away.
+	void WorldPtsToScreenPts3(const float (&a_worldToCamMatrix)[4][4], const RE::NiRect<float>& a_viewPort, std::span<const RE::NiPoint3> a_points, std::span<RE::NiPoint2> a_outScreenPoints, std::span<float> a_outDepths, float a_zeroTolerance = 1e-5f);
+}
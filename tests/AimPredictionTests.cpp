@@ -0,0 +1,198 @@
+#include "MathUtils.h"
+#include "Test.h"
+
+namespace
+{
+	constexpr float gravity = 600.f;
+	constexpr float drag = 0.2f;
+	constexpr float hitDistance = 1.f;
+
+	struct Scenario
+	{
+		RE::NiPoint3 origin;
+		RE::NiPoint3 targetPosition;
+		RE::NiPoint3 targetVelocity;
+		float speed;
+	};
+
+	// strafing targets well within range of a projectile faster than them
+	std::vector<Scenario> GetRandomScenarios(std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		std::uniform_real_distribution<float> distance(500.f, 3000.f);
+		std::uniform_real_distribution<float> targetSpeed(0.f, 400.f);
+		std::uniform_real_distribution<float> speed(2000.f, 4000.f);
+
+		std::vector<Scenario> scenarios(a_count);
+		for (auto& scenario : scenarios) {
+			RE::NiPoint3 direction{ unit(random), unit(random), unit(random) * 0.2f };
+			direction.Unitize();
+			RE::NiPoint3 targetDirection{ unit(random), unit(random), 0.f };
+			targetDirection.Unitize();
+
+			scenario.origin = { unit(random) * 1000.f, unit(random) * 1000.f, 100.f };
+			scenario.targetPosition = scenario.origin + direction * distance(random);
+			scenario.targetVelocity = targetDirection * targetSpeed(random);
+			scenario.speed = speed(random);
+		}
+		return scenarios;
+	}
+
+	// projectile position after a_time under gravity and linear drag, the same model the iterative solver inverts
+	RE::NiPoint3 GetProjectilePosition(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_velocity, float a_drag, float a_time)
+	{
+		if (a_drag <= FLT_EPSILON) {
+			RE::NiPoint3 position = a_origin + a_velocity * a_time;
+			position.z -= 0.5f * gravity * a_time * a_time;
+			return position;
+		}
+
+		const float terminalSpeed = gravity / a_drag;
+		const float decay = (1.f - std::exp(-a_drag * a_time)) / a_drag;
+		RE::NiPoint3 velocity = a_velocity;
+		velocity.z += terminalSpeed;
+		RE::NiPoint3 position = a_origin + velocity * decay;
+		position.z -= terminalSpeed * a_time;
+		return position;
+	}
+
+	// closest approach of the shot to the target, sampled every millisecond and then refined around the closest sample
+	float GetMissDistance(const Scenario& a_scenario, const RE::NiPoint3& a_velocity, float a_drag)
+	{
+		constexpr float step = 0.001f;
+
+		const auto getDistance = [&](float a_time) {
+			const auto projectilePosition = GetProjectilePosition(a_scenario.origin, a_velocity, a_drag, a_time);
+			return projectilePosition.GetDistance(a_scenario.targetPosition + a_scenario.targetVelocity * a_time);
+		};
+
+		float closestTime = 0.f;
+		float miss = getDistance(0.f);
+		for (std::uint32_t i = 1; i <= 5000; ++i) {
+			const float time = static_cast<float>(i) * step;
+			if (const float distance = getDistance(time); distance < miss) {
+				closestTime = time;
+				miss = distance;
+			}
+		}
+
+		float low = std::max(closestTime - step, 0.f);
+		float high = closestTime + step;
+		for (std::uint32_t i = 0; i < 32; ++i) {
+			const float lowThird = low + (high - low) / 3.f;
+			const float highThird = high - (high - low) / 3.f;
+			if (getDistance(lowThird) < getDistance(highThird)) {
+				high = highThird;
+			} else {
+				low = lowThird;
+			}
+		}
+		return std::min(miss, getDistance(0.5f * (low + high)));
+	}
+
+	struct Accuracy
+	{
+		float mean = 0.f;
+		float max = 0.f;
+		float maxSpeedError = 0.f;  // relative change of the launch speed
+		float hitRate = 0.f;
+	};
+
+	template <class Solve>
+	Accuracy GetAccuracy(const std::vector<Scenario>& a_scenarios, float a_drag, Solve&& a_solve)
+	{
+		Accuracy accuracy;
+		for (const auto& scenario : a_scenarios) {
+			RE::NiPoint3 velocity = (scenario.targetPosition - scenario.origin) / scenario.origin.GetDistance(scenario.targetPosition) * scenario.speed;
+			a_solve(scenario, velocity);
+
+			const float miss = GetMissDistance(scenario, velocity, a_drag);
+			accuracy.mean += miss / static_cast<float>(a_scenarios.size());
+			accuracy.max = std::max(accuracy.max, miss);
+			accuracy.hitRate += miss <= hitDistance ? 1.f / static_cast<float>(a_scenarios.size()) : 0.f;
+			accuracy.maxSpeedError = std::max(accuracy.maxSpeedError, std::fabs(velocity.Length() - scenario.speed) / scenario.speed);
+		}
+		return accuracy;
+	}
+
+	Accuracy GetQuadraticAccuracy(const std::vector<Scenario>& a_scenarios, float a_drag)
+	{
+		return GetAccuracy(a_scenarios, a_drag, [](const Scenario& a_scenario, RE::NiPoint3& a_velocity) {
+			PredictAimProjectile(a_scenario.origin, a_scenario.targetPosition, a_scenario.targetVelocity, gravity, a_velocity);
+		});
+	}
+
+	Accuracy GetIterativeAccuracy(const std::vector<Scenario>& a_scenarios, float a_drag)
+	{
+		return GetAccuracy(a_scenarios, a_drag, [a_drag](const Scenario& a_scenario, RE::NiPoint3& a_velocity) {
+			PredictAimProjectileIterative(a_scenario.origin, a_scenario.targetPosition, a_scenario.targetVelocity, gravity, a_drag, a_velocity);
+		});
+	}
+
+	void ReportAccuracy(const char* a_name, const Accuracy& a_accuracy)
+	{
+		std::printf("  %-48s hits %6.2f%%, mean miss %8.2f, max miss %8.2f, max speed error %6.2f%%\n", a_name, a_accuracy.hitRate * 100.f, a_accuracy.mean, a_accuracy.max, a_accuracy.maxSpeedError * 100.f);
+	}
+}
+
+TEST_CASE(AimPredictionWithoutDrag)
+{
+	const auto scenarios = GetRandomScenarios(500, 1);
+
+	// both solvers hit a constant velocity target, only the iterative one keeps the launch speed
+	const auto quadratic = GetQuadraticAccuracy(scenarios, 0.f);
+	const auto iterative = GetIterativeAccuracy(scenarios, 0.f);
+	CHECK(quadratic.max <= hitDistance);
+	CHECK(iterative.max <= hitDistance);
+	CHECK(iterative.maxSpeedError <= 0.01f);
+}
+
+TEST_CASE(AimPredictionWithDrag)
+{
+	const auto scenarios = GetRandomScenarios(500, 2);
+
+	// only the iterative solver accounts for the slowdown. The rare far shot at a receding target where its fixed point
+	// iteration does not converge in time falls back to the quadratic solution.
+	const auto quadratic = GetQuadraticAccuracy(scenarios, drag);
+	const auto iterative = GetIterativeAccuracy(scenarios, drag);
+	CHECK(iterative.hitRate >= 0.99f);
+	CHECK(iterative.hitRate > quadratic.hitRate);
+	CHECK(iterative.mean < quadratic.mean);
+}
+
+BENCHMARK(AimPrediction)
+{
+	constexpr std::uint32_t count = 4000;
+	const auto scenarios = GetRandomScenarios(count, 3);
+
+	ReportAccuracy("quadratic, no drag", GetQuadraticAccuracy(scenarios, 0.f));
+	ReportAccuracy("iterative, no drag", GetIterativeAccuracy(scenarios, 0.f));
+	ReportAccuracy("quadratic, drag", GetQuadraticAccuracy(scenarios, drag));
+	ReportAccuracy("iterative, drag", GetIterativeAccuracy(scenarios, drag));
+
+	const auto getInitialVelocity = [&](const Scenario& a_scenario) {
+		return (a_scenario.targetPosition - a_scenario.origin) / a_scenario.origin.GetDistance(a_scenario.targetPosition) * a_scenario.speed;
+	};
+
+	Test::Report("PredictAimProjectile", Test::Measure(count, [&](std::uint32_t a_i) {
+		const auto& scenario = scenarios[a_i];
+		auto velocity = getInitialVelocity(scenario);
+		PredictAimProjectile(scenario.origin, scenario.targetPosition, scenario.targetVelocity, gravity, velocity);
+		Test::DoNotOptimize(velocity);
+	}));
+
+	Test::Report("PredictAimProjectileIterative, no drag", Test::Measure(count, [&](std::uint32_t a_i) {
+		const auto& scenario = scenarios[a_i];
+		auto velocity = getInitialVelocity(scenario);
+		PredictAimProjectileIterative(scenario.origin, scenario.targetPosition, scenario.targetVelocity, gravity, 0.f, velocity);
+		Test::DoNotOptimize(velocity);
+	}));
+
+	Test::Report("PredictAimProjectileIterative, drag", Test::Measure(count, [&](std::uint32_t a_i) {
+		const auto& scenario = scenarios[a_i];
+		auto velocity = getInitialVelocity(scenario);
+		PredictAimProjectileIterative(scenario.origin, scenario.targetPosition, scenario.targetVelocity, gravity, drag, velocity);
+		Test::DoNotOptimize(velocity);
+	}));
+}
@@ -0,0 +1,158 @@
+#include "MathUtils.h"
+#include "Test.h"
+
+namespace
+{
+	// the loops NormalAbsoluteAngle and NormalRelativeAngle used to be
+	float GetReferenceAbsoluteAngle(float a_angle)
+	{
+		while (a_angle < 0)
+			a_angle += TWO_PI;
+		while (a_angle > TWO_PI)
+			a_angle -= TWO_PI;
+		return a_angle;
+	}
+
+	float GetReferenceRelativeAngle(float a_angle)
+	{
+		while (a_angle > PI)
+			a_angle -= TWO_PI;
+		while (a_angle < -PI)
+			a_angle += TWO_PI;
+		return a_angle;
+	}
+
+	// every a_stride-th float of [-a_max, a_max], plus every float within a_window ulps of each multiple of PI in it, where the
+	// wraps happen
+	std::vector<float> GetAngles(float a_max, std::uint32_t a_stride, std::uint32_t a_window)
+	{
+		std::vector<float> angles;
+		const auto maxBits = std::bit_cast<std::uint32_t>(a_max);
+		for (std::uint32_t bits = 0; bits <= maxBits; bits += a_stride) {
+			const float angle = std::bit_cast<float>(bits);
+			angles.push_back(angle);
+			angles.push_back(-angle);
+		}
+
+		for (float multiple = -a_max; multiple <= a_max; multiple += PI) {
+			const float center = PI * std::round(multiple / PI);
+			const auto centerBits = std::bit_cast<std::uint32_t>(std::fabs(center));
+			for (std::uint32_t bits = centerBits - std::min(centerBits, a_window); bits <= centerBits + a_window; ++bits) {
+				const float angle = std::copysign(std::bit_cast<float>(bits), center);
+				angles.push_back(angle);
+			}
+		}
+		return angles;
+	}
+
+	// distance on the circle, the loops keep the upper bound while the wrap returns the lower one
+	float GetAngleError(float a_angle, float a_expected)
+	{
+		return std::fabs(std::remainder(a_angle - a_expected, TWO_PI));
+	}
+
+	template <class Normal, class Reference>
+	void CheckEquivalence(Normal&& a_normal, Reference&& a_reference, float a_lower, float a_upper)
+	{
+		constexpr float maxAngle = 16.f * PI;
+
+		bool bInRange = true;
+		bool bInRangeUnchanged = true;
+		float maxError = 0.f;
+		for (const float angle : GetAngles(maxAngle, 97, 4096)) {
+			const float result = a_normal(angle);
+			bInRange &= result >= a_lower && result <= a_upper;
+			if (angle >= a_lower && angle < a_upper) {
+				bInRangeUnchanged &= result == angle;
+			}
+
+			// both lose the input's rounding error with every turn, allow for that
+			const float tolerance = 4.f * std::numeric_limits<float>::epsilon() * std::max(std::fabs(angle), PI);
+			maxError = std::max(maxError, GetAngleError(result, a_reference(angle)) / tolerance);
+		}
+		CHECK(bInRange);
+		CHECK(bInRangeUnchanged);
+		CHECK(maxError <= 1.f);
+	}
+
+	template <class Normal, class NormalBatch>
+	void CheckBatch(Normal&& a_normal, NormalBatch&& a_normalBatch)
+	{
+		auto angles = GetAngles(16.f * PI, 4099, 64);
+		auto expected = angles;
+		std::ranges::transform(expected, expected.begin(), a_normal);
+
+		// odd sizes cover the scalar tail
+		bool bSame = true;
+		for (const std::size_t size : { std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 4 }, std::size_t{ 7 }, angles.size() }) {
+			auto batch = angles;
+			a_normalBatch(std::span{ batch.data(), size });
+			bSame &= std::equal(batch.begin(), batch.begin() + size, expected.begin());
+			bSame &= std::equal(batch.begin() + size, batch.end(), angles.begin() + size);
+		}
+		CHECK(bSame);
+	}
+
+	// every finite float, including garbage far beyond what the loops could ever finish
+	template <class Normal>
+	void CheckFinite(Normal&& a_normal, float a_lower, float a_upper)
+	{
+		bool bInRange = true;
+		for (std::uint64_t bits = 0; bits < 0x7F800000; bits += 4093) {
+			const float angle = std::bit_cast<float>(static_cast<std::uint32_t>(bits));
+			for (const float value : { angle, -angle }) {
+				const float result = a_normal(value);
+				bInRange &= result >= a_lower && result <= a_upper;
+			}
+		}
+		CHECK(bInRange);
+		CHECK(a_normal(std::numeric_limits<float>::max()) >= a_lower);
+	}
+}
+
+TEST_CASE(NormalAbsoluteAngleMatchesLoop)
+{
+	CheckEquivalence(NormalAbsoluteAngle, GetReferenceAbsoluteAngle, 0.f, TWO_PI);
+	CheckBatch(NormalAbsoluteAngle, NormalAbsoluteAngles);
+	CheckFinite(NormalAbsoluteAngle, 0.f, TWO_PI);
+}
+
+TEST_CASE(NormalRelativeAngleMatchesLoop)
+{
+	CheckEquivalence(NormalRelativeAngle, GetReferenceRelativeAngle, -PI, PI);
+	CheckBatch(NormalRelativeAngle, NormalRelativeAngles);
+	CheckFinite(NormalRelativeAngle, -PI, PI);
+}
+
+BENCHMARK(NormalAngle)
+{
+	// mostly a turn or two out of range, like the deltas the rotation and camera code wraps
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> angle(-4.f * PI, 4.f * PI);
+	std::vector<float> angles(4096);
+	std::ranges::generate(angles, [&] { return angle(random); });
+	const auto count = static_cast<std::uint32_t>(angles.size());
+
+	Test::Report("relative, loop", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetReferenceRelativeAngle(angles[a_i]));
+	}));
+
+	Test::Report("NormalRelativeAngle", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(NormalRelativeAngle(angles[a_i]));
+	}));
+
+	auto batch = angles;
+	Test::Report("NormalRelativeAngles, per angle", Test::Measure(1000, [&](std::uint32_t) {
+		std::ranges::copy(angles, batch.begin());
+		NormalRelativeAngles(batch);
+		Test::DoNotOptimize(batch.back());
+	}) / count);
+
+	Test::Report("absolute, loop, 1e5", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetReferenceAbsoluteAngle(angles[a_i] + 1e5f));
+	}));
+
+	Test::Report("NormalAbsoluteAngle, 1e5", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(NormalAbsoluteAngle(angles[a_i] + 1e5f));
+	}));
+}
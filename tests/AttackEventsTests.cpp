@@ -0,0 +1,131 @@
+#include "AttackEvents.h"
+#include "Test.h"
+
+namespace
+{
+	using Transition = AttackEvents::Transition;
+
+	// the cases of the switch ProcessEvent used to walk, kept apart from the table so a typo in either shows up
+	const std::vector<std::pair<std::string_view, Transition>> referenceTags{
+		{ "CastOKStart"sv, Transition::kStart },
+		{ "preHitFrame"sv, Transition::kStart },
+		{ "MCO_AttackInitiate"sv, Transition::kStart },
+		{ "MCO_PowerAttackInitiate"sv, Transition::kStart },
+		{ "MCO_InputBuffer"sv, Transition::kStart },
+		{ "TDM_AttackStart"sv, Transition::kStart },
+		{ "Collision_AttackStart"sv, Transition::kStart },
+		{ "Collision_Start"sv, Transition::kStart },
+		{ "weaponSwing"sv, Transition::kMid },
+		{ "weaponLeftSwing"sv, Transition::kMid },
+		{ "SoundPlay.WPNSwingUnarmed"sv, Transition::kMid },
+		{ "TDM_AttackMid"sv, Transition::kMid },
+		{ "Collision_Add"sv, Transition::kMid },
+		{ "HitFrame"sv, Transition::kEnd },
+		{ "attackWinStart"sv, Transition::kEnd },
+		{ "SkySA_AttackWinStart"sv, Transition::kEnd },
+		{ "MCO_WinOpen"sv, Transition::kEnd },
+		{ "MCO_PowerWinOpen"sv, Transition::kEnd },
+		{ "MCO_TransitionOpen"sv, Transition::kEnd },
+		{ "MCO_Recovery"sv, Transition::kEnd },
+		{ "TDM_AttackEnd"sv, Transition::kEnd },
+		{ "Collision_AttackEnd"sv, Transition::kEnd },
+		{ "attackStop"sv, Transition::kStop },
+		{ "TDM_AttackStop"sv, Transition::kStop },
+		{ "SkySA_AttackWinEnd"sv, Transition::kStop },
+		{ "MCO_WinClose"sv, Transition::kStop },
+		{ "MCO_PowerWinClose"sv, Transition::kStop },
+		{ "MCO_TransitionClose"sv, Transition::kStop },
+	};
+
+	// what the player's graphs send while walking around, drawing a weapon and swinging it
+	const std::vector<std::string_view> eventStream{
+		"FootLeft"sv, "FootRight"sv, "FootLeft"sv, "FootRight"sv, "SoundPlay.FSTWalkL"sv, "SoundPlay.FSTWalkR"sv, "tailMTIdle"sv,
+		"TurnRight"sv, "turnStop"sv, "FootLeft"sv, "FootRight"sv, "BeginWeaponDraw"sv, "weaponDraw"sv, "WeapEquip_Out"sv,
+		"tailCombatIdle"sv, "FootLeft"sv, "FootRight"sv, "preHitFrame"sv, "weaponSwing"sv, "SoundPlay.WPNSwingUnarmed"sv,
+		"HitFrame"sv, "attackWinStart"sv, "tailCombatIdle"sv, "attackStop"sv, "FootLeft"sv, "FootRight"sv, "JumpUp"sv, "JumpFall"sv,
+		"JumpDown"sv, "FootLeft"sv, "FootRight"sv, "idleChairSitting"sv, "MCO_AttackInitiate"sv, "MCO_WinOpen"sv, "MCO_WinClose"sv,
+		"SoundPlay.NPCHumanCombatShieldBlock"sv, "blockStartOut"sv, "blockStop"sv, "FootLeft"sv, "FootRight"sv, "SprintStart"sv,
+		"SprintStop"sv, "FootLeft"sv, "FootRight"sv,
+	};
+
+	// the djb2 hash every event used to pay before the switch
+	std::uint32_t Djb2(std::string_view a_tag)
+	{
+		std::uint32_t hash = 5381;
+		for (const char character : a_tag) {
+			hash = hash * 33 + static_cast<std::uint8_t>(character);
+		}
+		return hash;
+	}
+}
+
+TEST_CASE(AttackEventsMapEveryTag)
+{
+	bool bEveryTag = true;
+	for (const auto& [tag, transition] : referenceTags) {
+		bEveryTag &= AttackEvents::Lookup(tag) == transition;
+
+		// the lookup doesn't depend on where the tag is stored
+		const std::string copy{ tag };
+		bEveryTag &= AttackEvents::Lookup(copy) == transition;
+	}
+	CHECK(bEveryTag);
+	CHECK(AttackEvents::detail::entries.size() == referenceTags.size());
+}
+
+TEST_CASE(AttackEventsRejectOtherTags)
+{
+	bool bRejected = true;
+	const auto reject = [&](std::string_view a_tag) {
+		bRejected &= AttackEvents::Lookup(a_tag) == Transition::kUnknown;
+	};
+
+	for (const auto tag : eventStream) {
+		if (std::ranges::find(referenceTags, tag, &std::pair<std::string_view, Transition>::first) == referenceTags.end()) {
+			reject(tag);
+		}
+	}
+
+	reject(""sv);
+	reject("H"sv);
+	reject(std::string(64, 'H'));
+	reject(std::string(200, 'a'));
+	reject("\xC3\x89vent"sv);
+
+	// near misses of every tag: a different case, cut short, extended, and every single character changed. The changed ones keep the
+	// length and mostly the first character, so they get past the filter and have to be told apart by the hash and the compare.
+	for (const auto& [tag, transition] : referenceTags) {
+		std::string upper{ tag };
+		std::ranges::transform(upper, upper.begin(), [](char a_character) { return static_cast<char>(std::toupper(static_cast<unsigned char>(a_character))); });
+		reject(upper);
+		reject(tag.substr(0, tag.size() - 1));
+		reject(std::string{ tag } + "2");
+
+		for (std::size_t i = 0; i < tag.size(); ++i) {
+			for (const char replacement : { 'a', 'Z', '_', '0', '\0' }) {
+				std::string changed{ tag };
+				if (changed[i] == replacement) {
+					continue;
+				}
+				changed[i] = replacement;
+				if (std::ranges::find(referenceTags, std::string_view{ changed }, &std::pair<std::string_view, Transition>::first) == referenceTags.end()) {
+					reject(changed);
+				}
+			}
+		}
+	}
+	CHECK(bRejected);
+}
+
+BENCHMARK(AttackEventsStream)
+{
+	const auto count = static_cast<std::uint32_t>(eventStream.size());
+
+	Test::Report("djb2 hash, per event", Test::Measure(count * 1000, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(Djb2(eventStream[a_i % count]));
+	}));
+
+	Test::Report("AttackEvents::Lookup, per event", Test::Measure(count * 1000, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(AttackEvents::Lookup(eventStream[a_i % count]));
+	}));
+}
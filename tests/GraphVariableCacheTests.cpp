@@ -0,0 +1,267 @@
+#include "GraphVariableCache.h"
+#include "Test.h"
+
+namespace
+{
+	using Variable = GraphVariableCache::Variable;
+
+	// the variables the leaning reads and writes, among the other floats of a humanoid behavior graph
+	constexpr std::array<const char*, 12> graphVariableNames{
+		"Speed", "Direction", "TurnDelta", "iState", "TDM_VelocityX", "TDM_VelocityY", "TDM_Pitch", "TDM_Roll", "TDM_SpineTurn", "bAnimationDriven", "iLeftHandType", "iRightHandType"
+	};
+
+	// one behavior graph as the game loads it, the names in the same order as the values
+	struct Graph
+	{
+		explicit Graph(std::span<const char* const> a_names)
+		{
+			for (const auto name : a_names) {
+				stringData.variableNames.push_back(name);
+				valueSet.wordVariableValues.push_back({ 0 });
+			}
+
+			// the engine's index is keyed by the interned name
+			for (std::int32_t i = 0; i < static_cast<std::int32_t>(a_names.size()); ++i) {
+				animationGraph.variableIndices[RE::BSFixedString(a_names[i]).c_str()] = i;
+			}
+
+			data.stringData.reset(std::addressof(stringData));
+			behaviorGraph.variableValueSet.reset(std::addressof(valueSet));
+			behaviorGraph.data.reset(std::addressof(data));
+			animationGraph.GetRuntimeData().behaviorGraph = std::addressof(behaviorGraph);
+		}
+
+		Graph(const Graph&) = delete;
+		Graph& operator=(const Graph&) = delete;
+
+		float Get(const char* a_name) const
+		{
+			float value = 0.f;
+			const auto it = animationGraph.variableIndices.find(RE::BSFixedString(a_name).c_str());
+			std::memcpy(&value, std::addressof(valueSet.wordVariableValues[it->second]), sizeof(value));
+			return value;
+		}
+
+		RE::hkbBehaviorGraphStringData stringData;
+		RE::hkbBehaviorGraphData data;
+		RE::hkbVariableValueSet valueSet;
+		RE::hkbBehaviorGraph behaviorGraph;
+		RE::BShkbAnimationGraph animationGraph;
+	};
+
+	struct TestActor
+	{
+		TestActor(std::uint32_t a_nativeHandle, std::uint32_t a_graphCount, std::span<const char* const> a_names = graphVariableNames) :
+			actor(a_nativeHandle)
+		{
+			for (std::uint32_t i = 0; i < a_graphCount; ++i) {
+				graphs.push_back(std::make_unique<Graph>(a_names));
+				manager.graphs.push_back(RE::BSTSmartPointer<RE::BShkbAnimationGraph>(std::addressof(graphs.back()->animationGraph)));
+			}
+			actor.animationGraphManager.reset(std::addressof(manager));
+		}
+
+		RE::BSAnimationGraphManager manager;
+		std::vector<std::unique_ptr<Graph>> graphs;
+		RE::Actor actor;
+	};
+
+	// what UpdateLeaning and SolveLeaning do for one actor, reading the previous lean and writing the new one
+	void UpdateLeaning(GraphVariableCache* a_cache, RE::Actor* a_actor, float a_value)
+	{
+		GraphVariableCache::Variables variables;
+		if (!a_cache->Get(a_actor, variables)) {
+			return;
+		}
+
+		float velocityX, velocityY, pitch, roll;
+		variables.GetFloat(Variable::kVelocityX, velocityX);
+		variables.GetFloat(Variable::kVelocityY, velocityY);
+		variables.GetFloat(Variable::kPitch, pitch);
+		variables.GetFloat(Variable::kRoll, roll);
+		Test::DoNotOptimize(velocityX + velocityY + pitch + roll);
+
+		const std::array<GraphVariableCache::Write, 5> writes{ { { Variable::kPitch, a_value }, { Variable::kRoll, a_value }, { Variable::kSpineTurn, a_value },
+			{ Variable::kVelocityX, a_value }, { Variable::kVelocityY, a_value } } };
+		a_cache->SetFloats(a_actor->GetHandle(), writes);
+	}
+
+	// the same through the engine's string keyed accessors, as before the cache
+	void UpdateLeaningByName(RE::Actor* a_actor, float a_value)
+	{
+		float velocityX, velocityY, pitch, roll;
+		if (!a_actor->GetGraphVariableFloat("TDM_VelocityX", velocityX)) {
+			return;
+		}
+		a_actor->GetGraphVariableFloat("TDM_VelocityY", velocityY);
+		a_actor->GetGraphVariableFloat("TDM_Pitch", pitch);
+		a_actor->GetGraphVariableFloat("TDM_Roll", roll);
+		Test::DoNotOptimize(velocityX + velocityY + pitch + roll);
+
+		a_actor->SetGraphVariableFloat("TDM_VelocityX", a_value);
+		a_actor->SetGraphVariableFloat("TDM_VelocityY", a_value);
+		a_actor->SetGraphVariableFloat("TDM_Pitch", a_value);
+		a_actor->SetGraphVariableFloat("TDM_Roll", a_value);
+		a_actor->SetGraphVariableFloat("TDM_SpineTurn", a_value);
+	}
+}
+
+TEST_CASE(GraphVariableCacheReadsAndWrites)
+{
+	auto cache = GraphVariableCache::GetSingleton();
+	cache->Clear();
+	cache->Update(1);
+
+	TestActor testActor(1, 1);
+	auto& graph = *testActor.graphs[0];
+	graph.valueSet.wordVariableValues[6].value = std::bit_cast<std::int32_t>(3.f);  // TDM_Pitch
+
+	GraphVariableCache::Variables variables;
+	CHECK(cache->Get(&testActor.actor, variables));
+	CHECK(variables.Has(Variable::kVelocityX) && variables.Has(Variable::kSpineTurn));
+	CHECK(!variables.Has(Variable::kDodge));
+
+	float pitch = 0.f;
+	CHECK(variables.GetFloat(Variable::kPitch, pitch));
+	CHECK(pitch == 3.f);
+
+	// queued until the flush, the last write of a variable wins
+	CHECK(variables.SetFloat(Variable::kRoll, 1.f));
+	CHECK(variables.SetFloat(Variable::kRoll, 2.f));
+	CHECK(!variables.SetFloat(Variable::kDodge, 1.f));
+	CHECK(graph.Get("TDM_Roll") == 0.f);
+	cache->Flush();
+	CHECK(graph.Get("TDM_Roll") == 2.f);
+
+	// no actor or no graph
+	RE::Actor noGraphs(2);
+	CHECK(!cache->Get(nullptr, variables));
+	CHECK(!cache->Get(&noGraphs, variables));
+}
+
+TEST_CASE(GraphVariableCacheResolvesReloadedGraphs)
+{
+	auto cache = GraphVariableCache::GetSingleton();
+	cache->Clear();
+	cache->Update(1);
+
+	TestActor testActor(1, 1);
+	GraphVariableCache::Variables variables;
+	CHECK(cache->Get(&testActor.actor, variables));
+	CHECK(variables.SetFloat(Variable::kPitch, 5.f));
+
+	// the graph was swapped for one with the variables in another order before the flush, the queued write is dropped
+	constexpr std::array<const char*, 3> reorderedNames{ "TDM_Roll", "TDM_Pitch", "Speed" };
+	Graph reloaded(reorderedNames);
+	testActor.manager.graphs[0] = RE::BSTSmartPointer<RE::BShkbAnimationGraph>(std::addressof(reloaded.animationGraph));
+	cache->Flush();
+	CHECK(reloaded.Get("TDM_Pitch") == 0.f && reloaded.Get("TDM_Roll") == 0.f);
+
+	CHECK(cache->Get(&testActor.actor, variables));
+	CHECK(!variables.Has(Variable::kVelocityX));
+	CHECK(variables.SetFloat(Variable::kPitch, 5.f));
+	cache->Flush();
+	CHECK(reloaded.Get("TDM_Pitch") == 5.f && reloaded.Get("TDM_Roll") == 0.f);
+
+	// handed out variables of an invalidated actor don't write
+	cache->Invalidate(&testActor.actor);
+	variables.SetFloat(Variable::kPitch, 6.f);
+	cache->Flush();
+	CHECK(reloaded.Get("TDM_Pitch") == 5.f);
+}
+
+TEST_CASE(GraphVariableCacheSuppressesPerGraph)
+{
+	auto cache = GraphVariableCache::GetSingleton();
+	cache->Clear();
+	cache->Update(1);
+
+	// a write of what the only graph already holds is dropped
+	TestActor npc(1, 1);
+	GraphVariableCache::Variables variables;
+	CHECK(cache->Get(&npc.actor, variables));
+	CHECK(variables.SetFloat(Variable::kPitch, 0.f));
+	npc.graphs[0]->valueSet.wordVariableValues[6].value = std::bit_cast<std::int32_t>(7.f);  // changed behind the cache's back, a flush would undo it
+	cache->Flush();
+	CHECK(npc.graphs[0]->Get("TDM_Pitch") == 7.f);
+
+	// the player's first and third person graphs, the inactive one is behind. The write matches the active graph and still has to reach it.
+	TestActor player(2, 2);
+	player.graphs[1]->valueSet.wordVariableValues[6].value = std::bit_cast<std::int32_t>(4.f);
+	CHECK(cache->Get(&player.actor, variables));
+	CHECK(variables.SetFloat(Variable::kPitch, 0.f));
+	CHECK(variables.SetFloat(Variable::kRoll, 1.f));
+	cache->Flush();
+	CHECK(player.graphs[0]->Get("TDM_Pitch") == 0.f && player.graphs[1]->Get("TDM_Pitch") == 0.f);
+	CHECK(player.graphs[0]->Get("TDM_Roll") == 1.f && player.graphs[1]->Get("TDM_Roll") == 1.f);
+}
+
+TEST_CASE(GraphVariableCacheSetsSeveralFloats)
+{
+	auto cache = GraphVariableCache::GetSingleton();
+	cache->Clear();
+	cache->Update(1);
+
+	TestActor testActor(1, 1);
+	GraphVariableCache::Variables variables;
+	CHECK(cache->Get(&testActor.actor, variables));
+
+	// the variables the graph doesn't have are skipped
+	const std::array<GraphVariableCache::Write, 3> writes{ { { Variable::kPitch, 1.f }, { Variable::kDodge, 1.f }, { Variable::kRoll, 2.f } } };
+	cache->SetFloats(testActor.actor.GetHandle(), writes);
+	cache->Flush();
+	CHECK(testActor.graphs[0]->Get("TDM_Pitch") == 1.f && testActor.graphs[0]->Get("TDM_Roll") == 2.f);
+
+	// an invalidated actor has to be handed out again first
+	const std::array<GraphVariableCache::Write, 1> laterWrites{ { { Variable::kPitch, 5.f } } };
+	cache->Invalidate(&testActor.actor);
+	cache->SetFloats(testActor.actor.GetHandle(), laterWrites);
+	cache->Flush();
+	CHECK(testActor.graphs[0]->Get("TDM_Pitch") == 1.f);
+
+	// no actor at all
+	cache->SetFloats(RE::ActorHandle(), laterWrites);
+	cache->Flush();
+}
+
+BENCHMARK(GraphVariableCacheLeaning)
+{
+	auto cache = GraphVariableCache::GetSingleton();
+
+	struct Crowd
+	{
+		std::uint32_t size;
+		const char* byNameName;
+		const char* cacheName;
+	};
+
+	// one frame of leaning reads and writes for the whole crowd, per actor. The values change every frame so no write is suppressed.
+	for (const auto& crowd : { Crowd{ 50, "by name, 50 actors, per actor", "GraphVariableCache, 50 actors, per actor" },
+			 Crowd{ 200, "by name, 200 actors, per actor", "GraphVariableCache, 200 actors, per actor" },
+			 Crowd{ 500, "by name, 500 actors, per actor", "GraphVariableCache, 500 actors, per actor" } }) {
+		std::vector<std::unique_ptr<TestActor>> actors;
+		for (std::uint32_t i = 0; i < crowd.size; ++i) {
+			actors.push_back(std::make_unique<TestActor>(i + 1, 1));
+		}
+
+		std::uint32_t frame = 0;
+		Test::Report(crowd.byNameName, Test::Measure(20, [&](std::uint32_t) {
+			const auto value = static_cast<float>(++frame);
+			for (const auto& actor : actors) {
+				UpdateLeaningByName(&actor->actor, value);
+			}
+		}) / crowd.size);
+
+		cache->Clear();
+		Test::Report(crowd.cacheName, Test::Measure(20, [&](std::uint32_t) {
+			const auto value = static_cast<float>(++frame);
+			cache->Update(frame);
+			for (const auto& actor : actors) {
+				UpdateLeaning(cache, &actor->actor, value);
+			}
+			cache->Flush();
+		}) / crowd.size);
+	}
+
+	cache->Clear();
+}
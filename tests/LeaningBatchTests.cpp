@@ -0,0 +1,170 @@
+#include "LeaningBatch.h"
+#include "MathUtils.h"
+#include "Test.h"
+
+namespace
+{
+	struct Entry
+	{
+		RE::NiPoint2 forward;
+		float speedPct;
+		float heading;
+		float deltaTime;
+		RE::NiPoint2 previousVelocity;
+		float previousPitch;
+		float previousRoll;
+		bool bUpright;
+	};
+
+	struct Result
+	{
+		RE::NiPoint2 velocity;
+		float pitch;
+		float roll;
+	};
+
+	LeaningBatch::Parameters GetParameters()
+	{
+		LeaningBatch::Parameters parameters;
+		parameters.leaningMult = 1.f;
+		parameters.leaningSpeed = 4.f;
+		parameters.maxLeaningStrength = 50.f;
+		return parameters;
+	}
+
+	// a crowd walking and running in every direction, some of them attacking
+	std::vector<Entry> GetRandomEntries(std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		std::uniform_real_distribution<float> speedPct(0.f, 2.f);
+		std::uniform_real_distribution<float> deltaTime(0.f, 0.1f);
+
+		std::vector<Entry> entries(a_count);
+		for (auto& entry : entries) {
+			const float heading = unit(random) * PI;
+			entry.forward = { std::sin(heading), std::cos(heading) };
+			entry.speedPct = speedPct(random);
+			entry.heading = unit(random) * PI;
+			entry.deltaTime = deltaTime(random);
+			entry.previousVelocity = { unit(random) * 2.f, unit(random) * 2.f };
+			entry.previousPitch = unit(random) * 20.f;
+			entry.previousRoll = unit(random) * 20.f;
+			entry.bUpright = random() % 8 == 0;
+		}
+		return entries;
+	}
+
+	void Fill(LeaningBatch& a_batch, std::span<const Entry> a_entries)
+	{
+		a_batch.Clear();
+		for (const auto& entry : a_entries) {
+			a_batch.Add(entry.forward, entry.speedPct, entry.heading, entry.deltaTime, entry.previousVelocity, entry.previousPitch, entry.previousRoll, entry.bUpright);
+		}
+	}
+
+	Result GetResult(const LeaningBatch& a_batch, std::uint32_t a_index, const Entry& a_entry)
+	{
+		const auto velocity = a_batch.HasVelocity(a_index) ? a_batch.GetVelocity(a_index) : a_entry.previousVelocity;
+		return { velocity, a_batch.GetPitch(a_index), a_batch.GetRoll(a_index) };
+	}
+
+	// what UpdateLeaning used to do for every actor, on the 3D vectors
+	Result GetReferenceResult(const Entry& a_entry, const LeaningBatch::Parameters& a_parameters)
+	{
+		Result result{ a_entry.previousVelocity, a_entry.previousPitch, a_entry.previousRoll };
+		float desiredPitch = 0.f;
+		float desiredRoll = 0.f;
+
+		if (!a_entry.bUpright) {
+			RE::NiPoint3 worldVelocity{ -a_entry.forward.x, -a_entry.forward.y, 0.f };
+			worldVelocity *= a_entry.speedPct * a_parameters.leaningMult;
+			const RE::NiPoint3 previousVelocity{ a_entry.previousVelocity.x, a_entry.previousVelocity.y, 0.f };
+
+			RE::NiPoint3 worldAcceleration{ 0.f, 0.f, 0.f };
+			if (a_entry.deltaTime > 0.f) {
+				worldAcceleration = (worldVelocity - previousVelocity) / a_entry.deltaTime;
+			}
+
+			worldAcceleration *= worldAcceleration.Dot(worldVelocity) > 0 ? 1.f : 0.5f;
+			worldAcceleration = ClampSizeMax(worldAcceleration, a_parameters.maxLeaningStrength);
+			const auto acceleration = RotateAngleAxis(worldAcceleration, a_entry.heading, { 0.f, 0.f, 1.f });
+
+			desiredPitch = acceleration.y;
+			desiredRoll = acceleration.x;
+			result.velocity = { worldVelocity.x, worldVelocity.y };
+		}
+
+		result.roll = InterpTo(result.roll, desiredRoll, a_entry.deltaTime, a_parameters.leaningSpeed);
+		result.pitch = InterpTo(result.pitch, desiredPitch, a_entry.deltaTime, a_parameters.leaningSpeed);
+		return result;
+	}
+}
+
+TEST_CASE(LeaningBatchMatchesReference)
+{
+	const auto entries = GetRandomEntries(2000, 1);
+	const auto parameters = GetParameters();
+
+	LeaningBatch batch;
+	Fill(batch, entries);
+	batch.Solve(parameters);
+	CHECK(batch.GetSize() == entries.size());
+
+	// the lean is at most maxLeaningStrength, so absolute errors are fine
+	float maxError = 0.f;
+	for (std::uint32_t i = 0; i < entries.size(); ++i) {
+		const auto result = GetResult(batch, i, entries[i]);
+		const auto reference = GetReferenceResult(entries[i], parameters);
+		maxError = std::max({ maxError, std::fabs(result.velocity.x - reference.velocity.x), std::fabs(result.velocity.y - reference.velocity.y),
+			std::fabs(result.pitch - reference.pitch), std::fabs(result.roll - reference.roll) });
+	}
+	CHECK(maxError <= 1e-4f);
+}
+
+TEST_CASE(LeaningBatchIgnoresStaleVelocity)
+{
+	const auto parameters = GetParameters();
+
+	// running ahead, with the velocity the graph kept from before the actor was frozen standing still
+	LeaningBatch batch;
+	batch.Add({ 0.f, 1.f }, 1.f, 0.f, 1.f / 60.f, { 0.f, 0.f }, 0.f, 0.f, false, true);
+	batch.Add({ 0.f, 1.f }, 1.f, 0.f, 1.f / 60.f, { 0.f, 0.f }, 0.f, 0.f, false);
+	batch.Solve(parameters);
+
+	// the velocity is taken up without a lean, a fresh one leans into the start
+	CHECK(batch.HasVelocity(0));
+	CHECK(batch.GetVelocity(0).x == batch.GetVelocity(1).x && batch.GetVelocity(0).y == batch.GetVelocity(1).y);
+	CHECK(batch.GetPitch(0) == 0.f && batch.GetRoll(0) == 0.f);
+	CHECK(std::fabs(batch.GetPitch(1)) > 1.f);
+}
+
+BENCHMARK(LeaningBatchSolve)
+{
+	const auto parameters = GetParameters();
+
+	// solving the same batch again only keeps interpolating, the cost per entry stays the same
+	struct Crowd
+	{
+		std::uint32_t size;
+		const char* referenceName;
+		const char* batchName;
+	};
+
+	for (const auto& crowd : { Crowd{ 100, "reference, 100 actors, per actor", "LeaningBatch::Solve, 100 actors, per actor" },
+			 Crowd{ 1000, "reference, 1000 actors, per actor", "LeaningBatch::Solve, 1000 actors, per actor" },
+			 Crowd{ 10000, "reference, 10000 actors, per actor", "LeaningBatch::Solve, 10000 actors, per actor" } }) {
+		const auto entries = GetRandomEntries(crowd.size, 3);
+
+		Test::Report(crowd.referenceName, Test::Measure(crowd.size, [&](std::uint32_t a_i) {
+			Test::DoNotOptimize(GetReferenceResult(entries[a_i], parameters));
+		}));
+
+		LeaningBatch batch;
+		Fill(batch, entries);
+		Test::Report(crowd.batchName, Test::Measure(100, [&](std::uint32_t) {
+			batch.Solve(parameters);
+			Test::DoNotOptimize(batch.GetRoll(crowd.size - 1));
+		}) / crowd.size);
+	}
+}
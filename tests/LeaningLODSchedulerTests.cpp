@@ -0,0 +1,176 @@
+#include "LeaningBatch.h"
+#include "LeaningLODScheduler.h"
+#include "Test.h"
+
+namespace
+{
+	using Level = LeaningLODScheduler::Level;
+
+	constexpr float deltaTime = 1.f / 60.f;
+	constexpr std::uint32_t interval = 3;
+
+	// the delta times a_level gets over a_frames frames, 0 where the update is skipped
+	std::vector<float> Run(LeaningLODScheduler& a_scheduler, std::uint32_t a_actorHandle, Level a_level, std::uint32_t a_interval, std::uint32_t a_firstFrame, std::uint32_t a_frames)
+	{
+		std::vector<float> deltaTimes;
+		for (std::uint32_t frame = a_firstFrame; frame < a_firstFrame + a_frames; ++frame) {
+			a_scheduler.Update(frame);
+			float outDeltaTime = 0.f;
+			deltaTimes.push_back(a_scheduler.Schedule(a_actorHandle, a_level, a_interval, deltaTime, outDeltaTime) ? outDeltaTime : 0.f);
+		}
+		return deltaTimes;
+	}
+
+	// close to the camera, further away and off screen in equal parts
+	Level GetCrowdLevel(std::uint32_t a_actor)
+	{
+		return static_cast<Level>(a_actor % 3);
+	}
+}
+
+TEST_CASE(LeaningLODSchedulerFullRate)
+{
+	LeaningLODScheduler scheduler;
+	const auto deltaTimes = Run(scheduler, 1, Level::kFull, interval, 1, 10);
+	CHECK(std::ranges::all_of(deltaTimes, [](float a_deltaTime) { return a_deltaTime == deltaTime; }));
+}
+
+TEST_CASE(LeaningLODSchedulerReducedRate)
+{
+	// every third update, with the skipped time added so the lean moves as far as at full rate
+	LeaningLODScheduler scheduler;
+	const auto deltaTimes = Run(scheduler, 1, Level::kReduced, interval, 1, 9);
+	bool bEveryThird = true;
+	for (std::uint32_t i = 0; i < deltaTimes.size(); ++i) {
+		bEveryThird &= i % 3 == 2 ? std::fabs(deltaTimes[i] - 3.f * deltaTime) <= 1e-6f : deltaTimes[i] == 0.f;
+	}
+	CHECK(bEveryThird);
+	CHECK_NEAR(std::accumulate(deltaTimes.begin(), deltaTimes.end(), 0.f), 9.f * deltaTime, 1e-6f);
+
+	// frozen actors run at the same rate, the caller stops adding them once they are upright
+	CHECK(Run(scheduler, 2, Level::kFrozen, interval, 10, 3) == std::vector<float>(deltaTimes.begin(), deltaTimes.begin() + 3));
+
+	// an interval of zero or one is full rate
+	CHECK(Run(scheduler, 3, Level::kReduced, 0, 13, 2) == std::vector<float>({ deltaTime, deltaTime }));
+	CHECK(Run(scheduler, 4, Level::kReduced, 1, 15, 2) == std::vector<float>({ deltaTime, deltaTime }));
+}
+
+TEST_CASE(LeaningLODSchedulerDropsStaleTime)
+{
+	LeaningLODScheduler scheduler;
+	float outDeltaTime = 0.f;
+	scheduler.Update(1);
+	CHECK(!scheduler.Schedule(1, Level::kReduced, interval, deltaTime, outDeltaTime));
+	scheduler.Update(2);
+	CHECK(!scheduler.Schedule(1, Level::kReduced, interval, deltaTime, outDeltaTime));
+
+	// the actor missed a frame, the time it had collected is from before that
+	scheduler.Update(4);
+	CHECK(scheduler.Schedule(1, Level::kReduced, interval, deltaTime, outDeltaTime));
+	CHECK(outDeltaTime == deltaTime);
+
+	// a long hitch isn't caught up on in one step
+	CHECK(!scheduler.Schedule(1, Level::kReduced, interval, 1.f, outDeltaTime));
+	CHECK(!scheduler.Schedule(1, Level::kReduced, interval, 1.f, outDeltaTime));
+	CHECK(scheduler.Schedule(1, Level::kReduced, interval, 1.f, outDeltaTime));
+	CHECK(outDeltaTime <= 0.25f);
+}
+
+TEST_CASE(LeaningLODSchedulerReportsResume)
+{
+	LeaningLODScheduler scheduler;
+	float outDeltaTime = 0.f;
+	bool bResumed = true;
+
+	// frozen, solved upright on every third update
+	std::uint32_t frame = 1;
+	for (; frame <= 6; ++frame) {
+		scheduler.Update(frame);
+		if (scheduler.Schedule(1, Level::kFrozen, interval, deltaTime, outDeltaTime, &bResumed)) {
+			CHECK(!bResumed);
+		}
+	}
+
+	// the first solve after that is told its velocity is stale, the next one isn't
+	scheduler.Update(frame++);
+	CHECK(scheduler.Schedule(1, Level::kFull, interval, deltaTime, outDeltaTime, &bResumed));
+	CHECK(bResumed);
+	scheduler.Update(frame++);
+	CHECK(scheduler.Schedule(1, Level::kFull, interval, deltaTime, outDeltaTime, &bResumed));
+	CHECK(!bResumed);
+
+	// the same going to the reduced rate, which only counts once the actor is solved again
+	for (std::uint32_t i = 0; i < interval; ++i) {
+		scheduler.Update(frame++);
+		if (scheduler.Schedule(2, Level::kFrozen, interval, deltaTime, outDeltaTime, &bResumed)) {
+			CHECK(!bResumed);
+		}
+	}
+	std::uint32_t resumes = 0;
+	for (std::uint32_t i = 0; i < 2 * interval; ++i) {
+		scheduler.Update(frame++);
+		resumes += scheduler.Schedule(2, Level::kReduced, interval, deltaTime, outDeltaTime, &bResumed) && bResumed ? 1 : 0;
+	}
+	CHECK(resumes == 1);
+
+	// actors that were never frozen don't resume
+	scheduler.Update(frame++);
+	CHECK(scheduler.Schedule(3, Level::kFull, interval, deltaTime, outDeltaTime, &bResumed));
+	CHECK(!bResumed);
+}
+
+BENCHMARK(LeaningLODCrowd)
+{
+	LeaningBatch::Parameters parameters;
+	parameters.leaningMult = 2.f;
+	parameters.leaningSpeed = 4.f;
+	parameters.maxLeaningStrength = 10.f;
+
+	struct Crowd
+	{
+		std::uint32_t size;
+		const char* fullRateName;
+		const char* lodName;
+	};
+
+	// one frame of scheduling and solving a crowd, against solving all of it every frame. The frames keep counting up across the runs.
+	std::uint32_t frame = 0;
+	for (const auto& crowd : { Crowd{ 50, "full rate, 50 actors, per frame", "LOD, 50 actors, per frame" },
+			 Crowd{ 200, "full rate, 200 actors, per frame", "LOD, 200 actors, per frame" },
+			 Crowd{ 1000, "full rate, 1000 actors, per frame", "LOD, 1000 actors, per frame" },
+			 Crowd{ 5000, "full rate, 5000 actors, per frame", "LOD, 5000 actors, per frame" } }) {
+		std::vector<RE::NiPoint2> forwards(crowd.size);
+		for (std::uint32_t actor = 0; actor < crowd.size; ++actor) {
+			const float heading = static_cast<float>(actor) * 0.1f;
+			forwards[actor] = { std::sin(heading), std::cos(heading) };
+		}
+
+		LeaningBatch batch;
+		const auto runFrame = [&](LeaningLODScheduler* a_scheduler, std::uint32_t a_frame) {
+			batch.Clear();
+			if (a_scheduler) {
+				a_scheduler->Update(a_frame);
+			}
+
+			for (std::uint32_t actor = 0; actor < crowd.size; ++actor) {
+				float actorDeltaTime = deltaTime;
+				if (a_scheduler && !a_scheduler->Schedule(actor + 1, GetCrowdLevel(actor), interval, deltaTime, actorDeltaTime)) {
+					continue;
+				}
+
+				batch.Add(forwards[actor], 1.f, static_cast<float>(actor) * 0.1f, actorDeltaTime, { 0.f, 0.f }, 0.f, 0.f, false);
+			}
+			batch.Solve(parameters);
+			Test::DoNotOptimize(batch.GetSize());
+		};
+
+		Test::Report(crowd.fullRateName, Test::Measure(300, [&](std::uint32_t) {
+			runFrame(nullptr, ++frame);
+		}));
+
+		LeaningLODScheduler scheduler;
+		Test::Report(crowd.lodName, Test::Measure(300, [&](std::uint32_t) {
+			runFrame(std::addressof(scheduler), ++frame);
+		}));
+	}
+}
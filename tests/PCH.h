@@ -0,0 +1,9 @@
+#pragma once
+
+#include <RE/Skyrim.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace std::literals;
@@ -0,0 +1,283 @@
+#include "MathUtils.h"
+#include "ProjectileGuidance.h"
+#include "ProjectileTargetTable.h"
+#include "Test.h"
+
+namespace
+{
+	constexpr std::uint32_t projectileCount = 200;
+	constexpr float projectileSpeed = 3000.f;
+	constexpr float deltaTime = 1.f / 60.f;
+
+	// the native handle of projectile i is i + 1, so the batched pass can find its position
+	std::uint32_t GetIndex(RE::ObjectRefHandle a_handle) { return a_handle.native_handle() - 1; }
+
+	std::vector<RE::NiPoint3> GetRandomLocations(std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> coordinate(-5000.f, 5000.f);
+
+		std::vector<RE::NiPoint3> locations(projectileCount);
+		for (auto& location : locations) {
+			location = { coordinate(random), coordinate(random), coordinate(random) * 0.1f + 1000.f };
+		}
+		return locations;
+	}
+
+	void Fill(ProjectileTargetTable& a_table)
+	{
+		for (std::uint32_t i = 0; i < projectileCount; ++i) {
+			a_table.Insert(Test::MakeHandle(i + 1), nullptr);
+		}
+	}
+
+	// what the hook does for every projectile when guidance is not batched
+	void StepPerProjectile(ProjectileTargetTable& a_table, std::vector<RE::NiPoint3>& a_locations, const RE::NiPoint3& a_targetPosition)
+	{
+		for (std::uint32_t i = 0; i < projectileCount; ++i) {
+			if (a_table.FindGuidance(Test::MakeHandle(i + 1))) {
+				ProjectileGuidance guidance;
+				guidance.Compute(a_locations[i], a_targetPosition);
+				a_locations[i] += guidance.direction * projectileSpeed * deltaTime;
+			}
+		}
+	}
+
+	// the closest a projectile moving from a_from to a_to gets to a_point, so a fast one can't step over the target
+	float GetClosestDistance(const RE::NiPoint3& a_from, const RE::NiPoint3& a_to, const RE::NiPoint3& a_point)
+	{
+		const auto segment = a_to - a_from;
+		const float lengthSquared = segment.SqrLength();
+		const float t = lengthSquared > 0.f ? std::clamp((a_point - a_from).Dot(segment) / lengthSquared, 0.f, 1.f) : 0.f;
+		return (a_from + segment * t).GetDistance(a_point);
+	}
+
+	float GetAngle(const RE::NiPoint3& a_from, const RE::NiPoint3& a_to)
+	{
+		return std::acos(std::clamp(a_from.Dot(a_to) / (a_from.Length() * a_to.Length()), -1.f, 1.f));
+	}
+
+	enum class Steering
+	{
+		kHoming,
+		kNavigation
+	};
+
+	struct Flight
+	{
+		bool bHit;
+		std::uint32_t updates;
+	};
+
+	// a target running tight circles around a point, and a shot fired at it from a_launch, aimed a_aimError radians off
+	Flight Fly(Steering a_steering, const RE::NiPoint3& a_launch, float a_aimError, float a_navigationConstant, std::mt19937& a_random)
+	{
+		constexpr float hitRadius = 30.f;
+		constexpr float targetSpeed = 500.f;
+		constexpr float circleRadius = 250.f;
+		constexpr std::uint32_t maxUpdates = 180;
+
+		std::uniform_real_distribution<float> phase(0.f, 2.f * PI);
+		const float startPhase = phase(a_random);
+		const auto getTargetPosition = [&](std::uint32_t a_update) {
+			const float angle = startPhase + targetSpeed / circleRadius * deltaTime * static_cast<float>(a_update);
+			return RE::NiPoint3{ circleRadius * std::cos(angle), circleRadius * std::sin(angle), 100.f };
+		};
+
+		RE::Projectile projectile;
+		RE::NiAVObject projectileNode;
+		projectile.data.location = a_launch;
+		auto aim = getTargetPosition(0) - a_launch;
+		aim.Unitize();
+		projectile.GetProjectileRuntimeData().linearVelocity = RotateAngleAxis(aim, a_aimError, { 0.f, 0.f, 1.f }) * projectileSpeed;
+
+		ProjectileGuidance guidance;
+		for (std::uint32_t update = 0; update < maxUpdates; ++update) {
+			const auto targetPosition = getTargetPosition(update);
+			if (a_steering == Steering::kHoming) {
+				guidance.Compute(projectile.data.location, targetPosition);
+				guidance.Apply(std::addressof(projectile), std::addressof(projectileNode));
+			} else {
+				guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), targetPosition, deltaTime, a_navigationConstant, PI);
+			}
+
+			const auto from = projectile.data.location;
+			projectile.data.location += projectile.GetProjectileRuntimeData().linearVelocity * deltaTime;
+			if (GetClosestDistance(from, projectile.data.location, getTargetPosition(update + 1)) <= hitRadius) {
+				return { true, update + 1 };
+			}
+		}
+		return { false, maxUpdates };
+	}
+
+	// the batched pass, then every projectile only applies its stored result
+	void StepBatched(ProjectileTargetTable& a_table, std::vector<RE::NiPoint3>& a_locations, const RE::NiPoint3& a_targetPosition, std::uint32_t a_frame)
+	{
+		a_table.ForEach([&](RE::ObjectRefHandle a_handle, RE::NiAVObject*, ProjectileGuidance& a_guidance) {
+			a_guidance.Compute(a_locations[GetIndex(a_handle)], a_targetPosition);
+			a_guidance.frame = a_frame;
+		});
+
+		for (std::uint32_t i = 0; i < projectileCount; ++i) {
+			const auto guidance = a_table.FindGuidance(Test::MakeHandle(i + 1));
+			if (guidance && guidance->frame == a_frame) {
+				a_locations[i] += guidance->direction * projectileSpeed * deltaTime;
+			}
+		}
+	}
+}
+
+TEST_CASE(ProjectileGuidanceBatchedMatchesPerProjectile)
+{
+	ProjectileTargetTable table;
+	Fill(table);
+
+	auto perProjectileLocations = GetRandomLocations(1);
+	auto batchedLocations = perProjectileLocations;
+
+	// a strafing target, followed for two seconds
+	for (std::uint32_t frame = 0; frame < 120; ++frame) {
+		const RE::NiPoint3 targetPosition{ 300.f * std::sin(static_cast<float>(frame) * 0.05f), 0.f, 100.f };
+		StepPerProjectile(table, perProjectileLocations, targetPosition);
+		StepBatched(table, batchedLocations, targetPosition, frame);
+	}
+
+	// same math on the same inputs, the trajectories must match exactly
+	bool bSameTrajectories = true;
+	for (std::uint32_t i = 0; i < projectileCount; ++i) {
+		bSameTrajectories &= perProjectileLocations[i] == batchedLocations[i];
+	}
+	CHECK(bSameTrajectories);
+}
+
+TEST_CASE(ProjectileGuidanceNavigateFirstUpdate)
+{
+	// nothing to compare the line of sight with yet, the velocity is kept and only the orientation follows it
+	RE::Projectile projectile;
+	RE::NiAVObject projectileNode;
+	projectile.data.location = { 0.f, 0.f, 100.f };
+	projectile.GetProjectileRuntimeData().linearVelocity = { 0.f, projectileSpeed, 0.f };
+
+	ProjectileGuidance guidance;
+	guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), { 500.f, 2000.f, 100.f }, deltaTime, 4.f, PI);
+	CHECK(projectile.GetProjectileRuntimeData().linearVelocity == RE::NiPoint3(0.f, projectileSpeed, 0.f));
+	CHECK(guidance.bHasLineOfSight);
+	CHECK_NEAR(projectile.data.angle.z, 0.f, 1e-5f);
+	CHECK_NEAR(projectileNode.local.rotate.entry[1][1], 1.f, 1e-5f);
+
+	// a target on the projectile itself has no line of sight, nothing changes
+	ProjectileGuidance onTarget;
+	onTarget.Navigate(std::addressof(projectile), std::addressof(projectileNode), projectile.data.location, deltaTime, 4.f, PI);
+	CHECK(!onTarget.bHasLineOfSight);
+}
+
+TEST_CASE(ProjectileGuidanceNavigateTurns)
+{
+	RE::Projectile projectile;
+	RE::NiAVObject projectileNode;
+	projectile.data.location = { 0.f, 0.f, 100.f };
+	projectile.GetProjectileRuntimeData().linearVelocity = { 0.f, projectileSpeed, 0.f };
+
+	ProjectileGuidance guidance;
+	guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), { 0.f, 2000.f, 100.f }, deltaTime, 4.f, PI);
+
+	// the target stepped right, the line of sight rotated by lineOfSightAngle and the velocity turns N times as far, towards it
+	const RE::NiPoint3 targetPosition{ 20.f, 2000.f, 100.f };
+	const float lineOfSightAngle = std::atan2(20.f, 2000.f);
+	guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), targetPosition, deltaTime, 4.f, PI);
+	const auto velocity = projectile.GetProjectileRuntimeData().linearVelocity;
+	CHECK_NEAR(GetAngle({ 0.f, 1.f, 0.f }, velocity), 4.f * lineOfSightAngle, 1e-4f);
+	CHECK(velocity.x > 0.f);
+	CHECK_NEAR(velocity.Length(), projectileSpeed, projectileSpeed * 1e-5f);
+	CHECK_NEAR(guidance.direction.Dot(velocity) / projectileSpeed, 1.f, 1e-5f);
+
+	// a bigger jump is capped by the turn rate, and without a time step nothing turns
+	const auto before = velocity;
+	guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), { 1500.f, 2000.f, 100.f }, deltaTime, 4.f, PI);
+	CHECK_NEAR(GetAngle(before, projectile.GetProjectileRuntimeData().linearVelocity), PI * deltaTime, 1e-4f);
+
+	const auto capped = projectile.GetProjectileRuntimeData().linearVelocity;
+	guidance.Navigate(std::addressof(projectile), std::addressof(projectileNode), { -1500.f, 2000.f, 100.f }, 0.f, 4.f, PI);
+	CHECK(projectile.GetProjectileRuntimeData().linearVelocity == capped);
+}
+
+TEST_CASE(ProjectileGuidanceNavigateHitsTarget)
+{
+	// shots aimed up to a radian off a running target still get it, homing turns without a limit and is the upper bound
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> aimError(-1.f, 1.f);
+	std::uint32_t navigationHits = 0;
+	std::uint32_t homingHits = 0;
+	for (std::uint32_t shot = 0; shot < 100; ++shot) {
+		const float launchAngle = static_cast<float>(shot) * 0.37f;
+		const RE::NiPoint3 launch{ 2500.f * std::cos(launchAngle), 2500.f * std::sin(launchAngle), 150.f };
+		const float error = aimError(random);
+		auto navigationRandom = random;
+		navigationHits += Fly(Steering::kNavigation, launch, error, 4.f, navigationRandom).bHit ? 1 : 0;
+		homingHits += Fly(Steering::kHoming, launch, error, 4.f, random).bHit ? 1 : 0;
+	}
+	CHECK(homingHits == 100);
+	CHECK(navigationHits >= 95);
+}
+
+BENCHMARK(ProjectileGuidanceSimulation)
+{
+	// the same shots with each steering: how many hit, how long they fly and what an update costs
+	struct Run
+	{
+		Steering steering;
+		float navigationConstant;
+		const char* name;
+	};
+
+	constexpr std::uint32_t shots = 500;
+	for (const auto& run : { Run{ Steering::kHoming, 0.f, "homing" }, Run{ Steering::kNavigation, 3.f, "proportional navigation, N = 3" },
+			 Run{ Steering::kNavigation, 4.f, "proportional navigation, N = 4" }, Run{ Steering::kNavigation, 5.f, "proportional navigation, N = 5" } }) {
+		std::uint32_t hits = 0;
+		std::uint32_t updates = 0;
+		const double nanoseconds = Test::Measure(1, [&](std::uint32_t) {
+			std::mt19937 random(6);
+			std::uniform_real_distribution<float> aimError(-1.f, 1.f);
+			std::uniform_real_distribution<float> launchAngle(0.f, 2.f * PI);
+			std::uniform_real_distribution<float> launchDistance(1000.f, 4000.f);
+			hits = 0;
+			updates = 0;
+			for (std::uint32_t shot = 0; shot < shots; ++shot) {
+				const float angle = launchAngle(random);
+				const float distance = launchDistance(random);
+				const RE::NiPoint3 launch{ distance * std::cos(angle), distance * std::sin(angle), 150.f };
+				const auto flight = Fly(run.steering, launch, aimError(random), run.navigationConstant, random);
+				hits += flight.bHit ? 1 : 0;
+				updates += flight.updates;
+			}
+		});
+
+		std::printf(" %s: %u of %u shots hit, %.1f updates per shot\n", run.name, hits, shots, static_cast<double>(updates) / shots);
+		Test::Report("per update, with the flight", nanoseconds / updates);
+	}
+}
+
+BENCHMARK(ProjectileGuidance200Homing)
+{
+	constexpr std::uint32_t iterations = 2000;
+	const RE::NiPoint3 targetPosition{ 0.f, 0.f, 100.f };
+
+	ProjectileTargetTable table;
+	Fill(table);
+
+	// the locations are not advanced, so every frame steers from the same state
+	auto locations = GetRandomLocations(2);
+	auto frameLocations = locations;
+
+	Test::Report("per projectile, 200 projectiles", Test::Measure(iterations, [&](std::uint32_t) {
+		frameLocations = locations;
+		StepPerProjectile(table, frameLocations, targetPosition);
+		Test::DoNotOptimize(frameLocations.back());
+	}));
+
+	Test::Report("batched, 200 projectiles", Test::Measure(iterations, [&](std::uint32_t a_i) {
+		frameLocations = locations;
+		StepBatched(table, frameLocations, targetPosition, a_i);
+		Test::DoNotOptimize(frameLocations.back());
+	}));
+}
@@ -0,0 +1,132 @@
+#include "MathUtils.h"
+#include "Test.h"
+
+namespace
+{
+	// the libm path the projectile hooks used before GetProjectileOrientation
+	ProjectileOrientation GetReferenceOrientation(const RE::NiPoint3& a_direction)
+	{
+		ProjectileOrientation orientation;
+		orientation.pitch = std::asin(a_direction.z);
+		orientation.yaw = std::atan2(a_direction.x, a_direction.y);
+
+		if (orientation.yaw < 0.0) {
+			orientation.yaw += PI;
+		}
+
+		if (a_direction.x < 0.0) {
+			orientation.yaw += PI;
+		}
+
+		SetRotationMatrix(orientation.rotation, -a_direction.x, a_direction.y, a_direction.z);
+		return orientation;
+	}
+
+	// unit directions covering the whole sphere, including both poles and the axes
+	std::vector<RE::NiPoint3> GetSphereDirections()
+	{
+		constexpr std::uint32_t pitchSteps = 360;
+		constexpr std::uint32_t yawSteps = 720;
+
+		std::vector<RE::NiPoint3> directions;
+		directions.reserve((pitchSteps + 1) * yawSteps);
+		for (std::uint32_t i = 0; i <= pitchSteps; ++i) {
+			const float pitch = -0.5f * PI + PI * static_cast<float>(i) / pitchSteps;
+			for (std::uint32_t j = 0; j < yawSteps; ++j) {
+				const float yaw = 2.f * PI * static_cast<float>(j) / yawSteps;
+				RE::NiPoint3 direction{ std::cos(pitch) * std::sin(yaw), std::cos(pitch) * std::cos(yaw), std::sin(pitch) };
+				// divided rather than Unitize()d, which multiplies by the reciprocal and leaves the reference further off unit length
+				const float length = direction.Length();
+				direction = { direction.x / length, direction.y / length, direction.z / length };
+				directions.push_back(direction);
+			}
+		}
+		return directions;
+	}
+
+	// difference of two angles on the circle, so a yaw just below 2PI matches one just above 0
+	float GetAngleError(float a_angle, float a_expected)
+	{
+		return std::fabs(std::remainder(a_angle - a_expected, 2.f * PI));
+	}
+}
+
+TEST_CASE(FastAtan2MatchesAtan2)
+{
+	constexpr std::uint32_t steps = 2000;
+
+	float maxError = 0.f;
+	for (std::uint32_t i = 0; i <= steps; ++i) {
+		const float y = -1.f + 2.f * static_cast<float>(i) / steps;
+		for (std::uint32_t j = 0; j <= steps; ++j) {
+			const float x = -1.f + 2.f * static_cast<float>(j) / steps;
+			if (x == 0.f && y == 0.f) {
+				continue;
+			}
+			maxError = std::max(maxError, std::fabs(FastAtan2(y, x) - std::atan2(y, x)));
+		}
+	}
+	CHECK(maxError <= 1e-5f);
+
+	// scale invariant, exact on the axes
+	CHECK_NEAR(FastAtan2(3e-20f, 1e-20f), std::atan2(3.f, 1.f), 1e-5f);
+	CHECK_NEAR(FastAtan2(-5e20f, 2e20f), std::atan2(-5.f, 2.f), 1e-5f);
+	CHECK(FastAtan2(0.f, 1.f) == 0.f);
+	CHECK(FastAtan2(1.f, 0.f) == 0.5f * PI);
+	CHECK(FastAtan2(-1.f, 0.f) == -0.5f * PI);
+	CHECK(FastAtan2(0.f, -1.f) == PI);
+	CHECK(FastAtan2(0.f, 0.f) == 0.f);
+}
+
+TEST_CASE(ProjectileOrientationMatchesReference)
+{
+	float maxPitchError = 0.f;
+	float maxYawError = 0.f;
+	float maxRotationError = 0.f;
+	bool bYawInRange = true;
+	for (const auto& direction : GetSphereDirections()) {
+		const auto orientation = GetProjectileOrientation(direction);
+		const auto reference = GetReferenceOrientation(direction);
+
+		maxPitchError = std::max(maxPitchError, std::fabs(orientation.pitch - reference.pitch));
+		bYawInRange &= orientation.yaw >= 0.f && orientation.yaw < 2.f * PI;
+
+		// straight up or down the heading is undefined, and within a degree of that the 1 - z^2 in SetRotationMatrix cancels out
+		// so badly that the reference itself is off
+		if (1.f - direction.z * direction.z > 1e-4f) {
+			maxYawError = std::max(maxYawError, GetAngleError(orientation.yaw, reference.yaw));
+			for (std::uint32_t row = 0; row < 3; ++row) {
+				for (std::uint32_t column = 0; column < 3; ++column) {
+					maxRotationError = std::max(maxRotationError, std::fabs(orientation.rotation.entry[row][column] - reference.rotation.entry[row][column]));
+				}
+			}
+		}
+	}
+
+	CHECK(maxPitchError <= 1e-5f);
+	CHECK(maxYawError <= 1e-5f);
+	CHECK(maxRotationError <= 2e-5f);
+	CHECK(bYawInRange);
+}
+
+BENCHMARK(ProjectileOrientation)
+{
+	const auto directions = GetSphereDirections();
+	const auto count = static_cast<std::uint32_t>(directions.size());
+
+	Test::Report("asin/atan2 + SetRotationMatrix", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetReferenceOrientation(directions[a_i]));
+	}));
+
+	Test::Report("GetProjectileOrientation", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetProjectileOrientation(directions[a_i]));
+	}));
+
+	Test::Report("std::atan2", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(std::atan2(directions[a_i].x, directions[a_i].y));
+	}));
+
+	Test::Report("FastAtan2", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(FastAtan2(directions[a_i].x, directions[a_i].y));
+	}));
+}
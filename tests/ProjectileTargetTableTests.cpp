@@ -0,0 +1,137 @@
+#include "ProjectileTargetTable.h"
+#include "Test.h"
+
+namespace
+{
+	using Test::MakeHandle;
+
+	std::vector<std::uint32_t> GetRandomKeys(std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_int_distribution<std::uint32_t> key(1, std::numeric_limits<std::uint32_t>::max());
+
+		std::vector<std::uint32_t> keys(a_count);
+		for (auto& value : keys) {
+			value = key(random);
+		}
+		return keys;
+	}
+
+	// target points stay null, NiPointer would touch the reference count of anything else. Entries are told apart by tagging
+	// their guidance frame with the key instead.
+	bool Insert(ProjectileTargetTable& a_table, std::uint32_t a_key)
+	{
+		if (!a_table.Insert(MakeHandle(a_key), nullptr)) {
+			return false;
+		}
+		a_table.FindGuidance(MakeHandle(a_key))->frame = a_key;
+		return true;
+	}
+
+	std::optional<std::uint32_t> Find(ProjectileTargetTable& a_table, std::uint32_t a_key)
+	{
+		const auto guidance = a_table.FindGuidance(MakeHandle(a_key));
+		return guidance ? std::make_optional(guidance->frame) : std::nullopt;
+	}
+}
+
+TEST_CASE(ProjectileTargetTableInsertFindErase)
+{
+	ProjectileTargetTable table;
+	CHECK(table.IsEmpty());
+	CHECK(!table.Insert(MakeHandle(0), nullptr));
+
+	CHECK(table.Insert(MakeHandle(42), nullptr));
+	CHECK(table.FindGuidance(MakeHandle(42))->frame == ProjectileGuidance::invalidFrame);
+	table.FindGuidance(MakeHandle(42))->frame = 42;
+	CHECK(!Insert(table, 42));  // keeps the original entry
+	CHECK(Find(table, 42) == 42u);
+	CHECK(!Find(table, 43));
+	CHECK(table.GetSize() == 1);
+
+	table.Erase(MakeHandle(43));
+	CHECK(table.GetSize() == 1);
+	table.Erase(MakeHandle(42));
+	CHECK(table.IsEmpty());
+	CHECK(!Find(table, 42));
+}
+
+TEST_CASE(ProjectileTargetTableMatchesSetUnderChurn)
+{
+	// stays below the max load so Insert never expires, which would resolve the handles
+	const auto keys = GetRandomKeys(600, 1);
+
+	ProjectileTargetTable table;
+	std::unordered_set<std::uint32_t> reference;
+
+	std::mt19937 random(2);
+	std::uniform_int_distribution<std::size_t> pick(0, keys.size() - 1);
+	for (std::uint32_t i = 0; i < 200000; ++i) {
+		const auto key = keys[pick(random)];
+		if (random() % 2) {
+			CHECK(Insert(table, key) == reference.insert(key).second);
+		} else {
+			table.Erase(MakeHandle(key));
+			reference.erase(key);
+		}
+
+		if (i % 1000 == 0) {
+			// backward shift deletion must keep every remaining key reachable from its home slot
+			for (const auto value : keys) {
+				CHECK(Find(table, value) == (reference.contains(value) ? std::make_optional(value) : std::nullopt));
+			}
+		}
+	}
+	CHECK(table.GetSize() == reference.size());
+
+	std::uint32_t count = 0;
+	bool bAllTracked = true;
+	table.ForEach([&](RE::ObjectRefHandle a_handle, RE::NiAVObject*, ProjectileGuidance& a_guidance) {
+		bAllTracked &= reference.contains(a_handle.native_handle()) && a_guidance.frame == a_handle.native_handle();
+		++count;
+	});
+	CHECK(bAllTracked);
+	CHECK(count == reference.size());
+
+	table.Clear();
+	CHECK(table.IsEmpty());
+	for (const auto value : keys) {
+		CHECK(!Find(table, value));
+	}
+}
+
+BENCHMARK(ProjectileTargetTableChurn)
+{
+	// a volley worth of live projectiles, each one inserted on launch, looked up every frame and erased on impact
+	constexpr std::uint32_t live = 64;
+	constexpr std::uint32_t lookups = 8;
+	constexpr std::uint32_t iterations = 200000;
+
+	// the keys are used as a ring, so every run starts from the same live window
+	const auto keys = GetRandomKeys(iterations, 3);
+	const auto getKey = [&](std::uint32_t a_index) { return keys[a_index % iterations]; };
+
+	ProjectileTargetTable table;
+	std::unordered_map<std::uint32_t, RE::NiPointer<RE::NiAVObject>> map;
+	for (std::uint32_t i = 0; i < live; ++i) {
+		table.Insert(MakeHandle(keys[i]), nullptr);
+		map.emplace(keys[i], nullptr);
+	}
+
+	Test::Report("unordered_map", Test::Measure(iterations, [&](std::uint32_t a_i) {
+		map.emplace(getKey(a_i + live), nullptr);
+		for (std::uint32_t j = 1; j <= lookups; ++j) {
+			const auto it = map.find(getKey(a_i + j));
+			Test::DoNotOptimize(it != map.end() ? std::addressof(it->second) : nullptr);
+		}
+		map.erase(getKey(a_i));
+	}));
+
+	Test::Report("ProjectileTargetTable", Test::Measure(iterations, [&](std::uint32_t a_i) {
+		table.Insert(MakeHandle(getKey(a_i + live)), nullptr);
+		for (std::uint32_t j = 1; j <= lookups; ++j) {
+			Test::DoNotOptimize(table.FindGuidance(MakeHandle(getKey(a_i + j))));
+		}
+		table.Erase(MakeHandle(getKey(a_i)));
+	}));
+}
@@ -0,0 +1,101 @@
+#include "ScreenNeighborGraph.h"
+#include "Test.h"
+
+namespace
+{
+	using Direction = ScreenNeighborGraph::Direction;
+}
+
+TEST_CASE(ScreenNeighborGraphDirections)
+{
+	// a plus around the first node, screen y grows upwards
+	ScreenNeighborGraph graph;
+	const auto center = graph.AddNode({ 0.5f, 0.5f }, true);
+	const auto left = graph.AddNode({ 0.3f, 0.5f }, true);
+	const auto right = graph.AddNode({ 0.7f, 0.5f }, true);
+	const auto up = graph.AddNode({ 0.5f, 0.8f }, true);
+	const auto down = graph.AddNode({ 0.5f, 0.1f }, true);
+
+	CHECK(graph.FindNeighbor(center, Direction::kLeft) == left);
+	CHECK(graph.FindNeighbor(center, Direction::kRight) == right);
+	CHECK(graph.FindNeighbor(center, Direction::kUp) == up);
+	CHECK(graph.FindNeighbor(center, Direction::kDown) == down);
+
+	// nothing further out, and a node on the same column is neither left nor right of it
+	CHECK(graph.FindNeighbor(left, Direction::kLeft) == ScreenNeighborGraph::kInvalid);
+	CHECK(graph.FindNeighbor(up, Direction::kUp) == ScreenNeighborGraph::kInvalid);
+	CHECK(graph.FindNeighbor(up, Direction::kDown) == center);
+	CHECK(graph.FindNeighbor(up, Direction::kLeft) == left);
+
+	CHECK(graph.FindNeighbor(center, Direction::kTotal) == ScreenNeighborGraph::kInvalid);
+	CHECK(graph.FindNeighbor(graph.GetSize(), Direction::kLeft) == ScreenNeighborGraph::kInvalid);
+}
+
+TEST_CASE(ScreenNeighborGraphPrefersTheDirection)
+{
+	// a closer node well off the axis doesn't take over from one straight to the right, one only a little off it does
+	ScreenNeighborGraph graph;
+	const auto origin = graph.AddNode({ 0.5f, 0.5f }, true);
+	const auto straight = graph.AddNode({ 0.75f, 0.5f }, true);
+	graph.AddNode({ 0.6f, 0.65f }, true);
+	CHECK(graph.FindNeighbor(origin, Direction::kRight) == straight);
+
+	const auto slightlyOff = graph.AddNode({ 0.65f, 0.52f }, true);
+	CHECK(graph.FindNeighbor(origin, Direction::kRight) == slightlyOff);
+}
+
+TEST_CASE(ScreenNeighborGraphOffScreen)
+{
+	// off screen nodes can be switched from but never to
+	ScreenNeighborGraph graph;
+	const auto origin = graph.AddNode({ 0.5f, 0.5f }, false);
+	graph.AddNode({ 0.4f, 0.5f }, false);
+	const auto far = graph.AddNode({ 0.1f, 0.5f }, true);
+	CHECK(graph.FindNeighbor(origin, Direction::kLeft) == far);
+	CHECK(graph.FindNeighbor(far, Direction::kRight) == ScreenNeighborGraph::kInvalid);
+}
+
+TEST_CASE(ScreenNeighborGraphTies)
+{
+	// mirrored above and below the axis they score the same, the one added first wins whichever that is
+	for (const bool bUpperFirst : { true, false }) {
+		ScreenNeighborGraph graph;
+		const auto origin = graph.AddNode({ 0.5f, 0.5f }, true);
+		const auto first = graph.AddNode({ 0.7f, bUpperFirst ? 0.6f : 0.4f }, true);
+		graph.AddNode({ 0.7f, bUpperFirst ? 0.4f : 0.6f }, true);
+		CHECK(graph.FindNeighbor(origin, Direction::kRight) == first);
+	}
+
+	// the same position twice
+	ScreenNeighborGraph graph;
+	const auto origin = graph.AddNode({ 0.5f, 0.5f }, true);
+	const auto first = graph.AddNode({ 0.2f, 0.5f }, true);
+	graph.AddNode({ 0.2f, 0.5f }, true);
+	CHECK(graph.FindNeighbor(origin, Direction::kLeft) == first);
+}
+
+BENCHMARK(ScreenNeighborGraphSwitch)
+{
+	// one switch input, against linking every node in every direction up front as each locked frame used to
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> coordinate(0.f, 1.f);
+
+	for (const std::uint32_t count : { 10u, 50u, 200u }) {
+		ScreenNeighborGraph graph;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			graph.AddNode({ coordinate(random), coordinate(random) }, true);
+		}
+
+		std::printf(" %u nodes\n", count);
+		Test::Report("FindNeighbor, one input", Test::Measure(1000, [&](std::uint32_t a_i) {
+			Test::DoNotOptimize(graph.FindNeighbor(0, static_cast<Direction>(a_i % 4)));
+		}));
+		Test::Report("every node in every direction", Test::Measure(10, [&](std::uint32_t) {
+			for (std::uint32_t node = 0; node < count; ++node) {
+				for (std::uint32_t direction = 0; direction < 4; ++direction) {
+					Test::DoNotOptimize(graph.FindNeighbor(node, static_cast<Direction>(direction)));
+				}
+			}
+		}));
+	}
+}
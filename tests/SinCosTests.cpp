@@ -0,0 +1,151 @@
+#include "MathUtils.h"
+#include "Test.h"
+
+namespace
+{
+	// the largest absolute error against the double precision CRT over a_count evenly spaced angles in [-a_max, a_max]
+	float GetMaxError(float a_max, std::uint32_t a_count)
+	{
+		float maxError = 0.f;
+		for (std::uint32_t i = 0; i <= a_count; ++i) {
+			const float angle = -a_max + 2.f * a_max * static_cast<float>(i) / static_cast<float>(a_count);
+			float sin, cos;
+			SinCos(angle, sin, cos);
+			const double expectedSin = std::sin(static_cast<double>(angle));
+			const double expectedCos = std::cos(static_cast<double>(angle));
+			maxError = std::max({ maxError, static_cast<float>(std::fabs(sin - expectedSin)), static_cast<float>(std::fabs(cos - expectedCos)) });
+		}
+		return maxError;
+	}
+
+	// ProcessInput before the fused SinCos, a separate std::sin and std::cos in each of the three rotations
+	MovementInputDirections GetReferenceMovementInputDirections(const RE::NiPoint2& a_inputDirection, float a_characterRot, float a_cameraRotOffset)
+	{
+		const auto rotate = [](const RE::NiPoint2& a_vector, float a_angle) {
+			return RE::NiPoint2(a_vector.x * std::cos(a_angle) - a_vector.y * std::sin(a_angle), a_vector.x * std::sin(a_angle) + a_vector.y * std::cos(a_angle));
+		};
+
+		MovementInputDirections directions;
+		directions.character = rotate(RE::NiPoint2(0.f, 1.f), a_characterRot);
+		directions.cameraRelativeInput = rotate(a_inputDirection, -a_cameraRotOffset);
+		directions.worldRelativeInput = rotate(directions.cameraRelativeInput, a_characterRot);
+		directions.worldRelativeInput.Unitize();
+		return directions;
+	}
+
+	struct MovementInput
+	{
+		RE::NiPoint2 direction;
+		float characterRot;
+		float cameraRotOffset;
+	};
+
+	// thumbstick deflections with the character facing anywhere and the camera swung up to half a turn either way
+	std::vector<MovementInput> GetRandomMovementInputs(std::uint32_t a_count)
+	{
+		std::mt19937 random(2);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		std::uniform_real_distribution<float> characterRot(0.f, 2.f * PI);
+
+		std::vector<MovementInput> inputs(a_count);
+		for (auto& input : inputs) {
+			input.direction = { unit(random), unit(random) };
+			input.characterRot = characterRot(random);
+			input.cameraRotOffset = unit(random) * PI;
+		}
+		return inputs;
+	}
+
+	// every component, so none of the rotations can be left out
+	float GetSum(const MovementInputDirections& a_directions)
+	{
+		return a_directions.character.x + a_directions.character.y + a_directions.cameraRelativeInput.x + a_directions.cameraRelativeInput.y + a_directions.worldRelativeInput.x +
+		       a_directions.worldRelativeInput.y;
+	}
+
+	// the rest of the math ProcessInput does with the directions
+	float GetDesiredAngleAndDot(MovementInputDirections& a_directions)
+	{
+		return NormalAbsoluteAngle(-GetAngle(a_directions.character, a_directions.cameraRelativeInput)) + a_directions.character.Dot(a_directions.worldRelativeInput) + GetSum(a_directions);
+	}
+}
+
+TEST_CASE(SinCosMatchesCrt)
+{
+	static_assert(bFastTrig, "the tests build the fast path regardless of ENABLE_FAST_TRIG");
+
+	// the angles the rotation helpers see, then the whole range the reduction handles, where the error grows with the quadrant
+	CHECK(GetMaxError(2.f * PI, 1000000) <= 2e-7f);
+	CHECK(GetMaxError(32768.f, 4000000) <= 6e-7f);
+
+	// quarter turns, signed zeros and the hand off to the CRT past the reduction's range
+	for (const float angle : { 0.f, -0.f, PI2, -PI2, PI, -PI, 1e-30f, 32767.99f, -32767.99f, 32768.f, 1e6f, -1e6f }) {
+		float sin, cos;
+		SinCos(angle, sin, cos);
+		CHECK_NEAR(sin, std::sin(static_cast<double>(angle)), 1e-6);
+		CHECK_NEAR(cos, std::cos(static_cast<double>(angle)), 1e-6);
+		CHECK_NEAR(sin * sin + cos * cos, 1.0, 2e-6);
+	}
+}
+
+TEST_CASE(MovementInputDirectionsMatchReference)
+{
+	float maxError = 0.f;
+	for (const auto& input : GetRandomMovementInputs(10000)) {
+		const auto directions = GetMovementInputDirections(input.direction, input.characterRot, input.cameraRotOffset);
+		const auto reference = GetReferenceMovementInputDirections(input.direction, input.characterRot, input.cameraRotOffset);
+		for (const auto& [result, expected] : { std::pair{ directions.character, reference.character }, std::pair{ directions.cameraRelativeInput, reference.cameraRelativeInput },
+				 std::pair{ directions.worldRelativeInput, reference.worldRelativeInput } }) {
+			maxError = std::max({ maxError, std::fabs(result.x - expected.x), std::fabs(result.y - expected.y) });
+		}
+	}
+	CHECK(maxError <= 1e-6f);
+
+	// no input stays no input
+	const auto directions = GetMovementInputDirections({ 0.f, 0.f }, 1.f, 2.f);
+	CHECK(directions.worldRelativeInput.x == 0.f && directions.worldRelativeInput.y == 0.f);
+}
+
+BENCHMARK(SinCos)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> angle(-2.f * PI, 2.f * PI);
+	std::vector<float> angles(4096);
+	std::ranges::generate(angles, [&] { return angle(random); });
+	const auto count = static_cast<std::uint32_t>(angles.size());
+
+	Test::Report("std::sin + std::cos", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(std::sin(angles[a_i]) + std::cos(angles[a_i]));
+	}));
+
+	Test::Report("SinCos", Test::Measure(count, [&](std::uint32_t a_i) {
+		float sin, cos;
+		SinCos(angles[a_i], sin, cos);
+		Test::DoNotOptimize(sin + cos);
+	}));
+}
+
+BENCHMARK(MovementInputDirections)
+{
+	const auto inputs = GetRandomMovementInputs(4096);
+	const auto count = static_cast<std::uint32_t>(inputs.size());
+
+	// the rotations alone, then with the desired angle and pivot dot product ProcessInput takes from them, whose atan2 costs the same either way
+	Test::Report("separate sin and cos per rotation, rotations only", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetSum(GetReferenceMovementInputDirections(inputs[a_i].direction, inputs[a_i].characterRot, inputs[a_i].cameraRotOffset)));
+	}));
+
+	Test::Report("GetMovementInputDirections, rotations only", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(GetSum(GetMovementInputDirections(inputs[a_i].direction, inputs[a_i].characterRot, inputs[a_i].cameraRotOffset)));
+	}));
+
+	Test::Report("separate sin and cos per rotation, per input", Test::Measure(count, [&](std::uint32_t a_i) {
+		auto directions = GetReferenceMovementInputDirections(inputs[a_i].direction, inputs[a_i].characterRot, inputs[a_i].cameraRotOffset);
+		Test::DoNotOptimize(GetDesiredAngleAndDot(directions));
+	}));
+
+	Test::Report("GetMovementInputDirections, per input", Test::Measure(count, [&](std::uint32_t a_i) {
+		auto directions = GetMovementInputDirections(inputs[a_i].direction, inputs[a_i].characterRot, inputs[a_i].cameraRotOffset);
+		Test::DoNotOptimize(GetDesiredAngleAndDot(directions));
+	}));
+}
@@ -0,0 +1,117 @@
+#include "SkeletonBones.h"
+#include "Test.h"
+
+namespace
+{
+	// a humanoid sized skeleton: a spine, limbs and fingers branching off it, and the names interned the way BSFixedString does
+	struct Skeleton
+	{
+		std::vector<std::string> names;
+		std::vector<const char*> nodeNames;
+		std::vector<RE::NiAVObject> nodes;
+		std::vector<std::vector<std::uint32_t>> children;
+
+		explicit Skeleton(std::uint32_t a_boneCount) :
+			nodes(a_boneCount),
+			children(a_boneCount)
+		{
+			names.reserve(a_boneCount);
+			for (std::uint32_t bone = 0; bone < a_boneCount; ++bone) {
+				names.push_back("NPC Bone " + std::to_string(bone));
+				nodeNames.push_back(names.back().c_str());
+				if (bone > 0) {
+					children[bone % 8 == 0 ? 0 : (bone - 1) / 2].push_back(bone);
+				}
+			}
+		}
+
+		const char* GetName(std::uint32_t a_bone) const { return nodeNames[a_bone]; }
+
+		// the depth first walk the game does for every uncached lookup, comparing the interned names
+		RE::NiAVObject* Walk(std::uint32_t a_node, const char* a_name)
+		{
+			if (GetName(a_node) == a_name) {
+				return std::addressof(nodes[a_node]);
+			}
+			for (const auto child : children[a_node]) {
+				if (auto node = Walk(child, a_name)) {
+					return node;
+				}
+			}
+			return nullptr;
+		}
+	};
+}
+
+TEST_CASE(SkeletonBonesCacheLookups)
+{
+	Skeleton skeleton(150);
+	SkeletonBones bones;
+
+	std::uint32_t lookups = 0;
+	const auto lookup = [&](const char* a_name) {
+		++lookups;
+		return skeleton.Walk(0, a_name);
+	};
+
+	bool bFound = true;
+	for (std::uint32_t frame = 1; frame <= 3; ++frame) {
+		for (std::uint32_t bone = 0; bone < 150; ++bone) {
+			bFound &= bones.Find(skeleton.GetName(bone), frame, lookup) == std::addressof(skeleton.nodes[bone]);
+		}
+	}
+	CHECK(bFound);
+	CHECK(lookups == 150);
+	CHECK(bones.GetSize() == 150);
+}
+
+TEST_CASE(SkeletonBonesExpireMisses)
+{
+	Skeleton skeleton(150);
+	SkeletonBones bones;
+
+	std::uint32_t lookups = 0;
+	const auto lookup = [&](const char* a_name) {
+		++lookups;
+		return skeleton.Walk(0, a_name);
+	};
+
+	// a weapon node that only shows up once the weapon is drawn
+	const std::string weapon = "WEAPON";
+	CHECK(bones.Find(weapon.c_str(), 10, lookup) == nullptr);
+	CHECK(bones.Find(weapon.c_str(), 10 + SkeletonBones::maxMissAge, lookup) == nullptr);
+	CHECK(lookups == 1);
+
+	skeleton.nodeNames[149] = weapon.c_str();
+	CHECK(bones.Find(weapon.c_str(), 11 + SkeletonBones::maxMissAge, lookup) == std::addressof(skeleton.nodes[149]));
+	CHECK(lookups == 2);
+
+	// found bones are kept
+	CHECK(bones.Find(weapon.c_str(), 1000, lookup) == std::addressof(skeleton.nodes[149]));
+	CHECK(lookups == 2);
+}
+
+BENCHMARK(SkeletonBonesLookup)
+{
+	Skeleton skeleton(150);
+	const std::string missing = "NPC Missing";
+
+	// the target point lookups of a frame hit a handful of bones, spread over the skeleton
+	constexpr std::array<std::uint32_t, 4> targetBones{ 3, 40, 97, 149 };
+
+	Test::Report("scene graph walk, found bone", Test::Measure(10000, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(skeleton.Walk(0, skeleton.GetName(targetBones[a_i % targetBones.size()])));
+	}));
+	Test::Report("scene graph walk, missing bone", Test::Measure(10000, [&](std::uint32_t) {
+		Test::DoNotOptimize(skeleton.Walk(0, missing.c_str()));
+	}));
+
+	SkeletonBones bones;
+	const auto lookup = [&](const char* a_name) { return skeleton.Walk(0, a_name); };
+	Test::Report("SkeletonBones::Find, found bone", Test::Measure(10000, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(bones.Find(skeleton.GetName(targetBones[a_i % targetBones.size()]), 1, lookup));
+	}));
+	Test::Report("SkeletonBones::Find, missing bone", Test::Measure(10000, [&](std::uint32_t) {
+		Test::DoNotOptimize(bones.Find(missing.c_str(), 1, lookup));
+	}));
+}
@@ -0,0 +1,145 @@
+#include "TargetCandidateIndex.h"
+#include "Test.h"
+
+namespace
+{
+	constexpr float worldExtent = 20000.f;
+	constexpr float lockDistance = 2000.f;
+
+	std::vector<RE::NiPoint3> GetRandomPositions(std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> coordinate(-worldExtent, worldExtent);
+
+		std::vector<RE::NiPoint3> positions(a_count);
+		for (auto& position : positions) {
+			position = { coordinate(random), coordinate(random), coordinate(random) * 0.05f };
+		}
+		return positions;
+	}
+
+	void Fill(TargetCandidateIndex& a_index, const std::vector<RE::NiPoint3>& a_positions, std::size_t a_gridThreshold)
+	{
+		a_index.Clear();
+		for (const auto& position : a_positions) {
+			TargetCandidate candidate;
+			candidate.position = position;
+			candidate.maxDistance = lockDistance;
+			a_index.Insert(std::move(candidate));
+		}
+		a_index.Build(a_gridThreshold);
+	}
+
+	std::uint32_t CountInRadius(const std::vector<RE::NiPoint3>& a_positions, const RE::NiPoint3& a_origin, float a_radius)
+	{
+		std::uint32_t count = 0;
+		for (const auto& position : a_positions) {
+			const float dx = position.x - a_origin.x;
+			const float dy = position.y - a_origin.y;
+			if (dx * dx + dy * dy <= a_radius * a_radius) {
+				++count;
+			}
+		}
+		return count;
+	}
+}
+
+TEST_CASE(TargetCandidateIndexRadiusMatchesLinearScan)
+{
+	const auto positions = GetRandomPositions(2000, 1);
+	const auto origins = GetRandomPositions(200, 2);
+
+	// through the grid and with the linear fallback
+	for (const std::size_t gridThreshold : { std::size_t{ 0 }, TargetCandidateIndex::gridThreshold }) {
+		TargetCandidateIndex index;
+		Fill(index, positions, gridThreshold);
+		CHECK(index.GetSize() == positions.size());
+		CHECK(index.GetMaxDistance() == lockDistance);
+
+		// small radii walk the covered cells, large ones every candidate
+		for (const float radius : { 100.f, lockDistance, 5000.f, 3.f * worldExtent }) {
+			for (const auto& origin : origins) {
+				std::uint32_t count = 0;
+				bool bAllInRadius = true;
+				index.ForEachInRadius(origin, radius, [&](TargetCandidate& a_candidate) {
+					const float dx = a_candidate.position.x - origin.x;
+					const float dy = a_candidate.position.y - origin.y;
+					bAllInRadius &= dx * dx + dy * dy <= radius * radius;
+					++count;
+				});
+				CHECK(bAllInRadius);
+				CHECK(count == CountInRadius(positions, origin, radius));
+			}
+		}
+	}
+}
+
+TEST_CASE(TargetCandidateIndexCone)
+{
+	for (const std::size_t gridThreshold : { std::size_t{ 0 }, TargetCandidateIndex::gridThreshold }) {
+		TargetCandidateIndex index;
+		Fill(index, { { 100.f, 0.f, 0.f }, { 0.f, 100.f, 0.f }, { -100.f, 0.f, 0.f }, { 70.f, 70.f, 0.f }, { 0.f, 0.f, 0.f } }, gridThreshold);
+
+		std::uint32_t count = 0;
+		index.ForEachInCone({ 0.f, 0.f, 0.f }, { 1.f, 0.f }, 500.f, PI4 + 0.01f, [&](TargetCandidate&) { ++count; });
+		CHECK(count == 3);  // straight ahead, the 45 degree one and the one on the origin
+	}
+}
+
+BENCHMARK(TargetCandidateIndexQuery)
+{
+	// a frame clears, fills and builds the index once, then the lock-on, the target switching and the magnetism query it
+	constexpr std::uint32_t queriesPerFrame = 3;
+
+	const auto origins = GetRandomPositions(1024, 4);
+	const auto runFrame = [&](TargetCandidateIndex& a_index, const std::vector<RE::NiPoint3>& a_positions, std::size_t a_gridThreshold, std::uint32_t a_queries, std::uint32_t a_frame) {
+		a_index.Clear();
+		for (const auto& position : a_positions) {
+			TargetCandidate candidate;
+			candidate.position = position;
+			candidate.maxDistance = lockDistance;
+			a_index.Insert(std::move(candidate));
+		}
+		a_index.Build(a_gridThreshold);
+
+		std::uint32_t found = 0;
+		for (std::uint32_t query = 0; query < a_queries; ++query) {
+			a_index.ForEachInRadius(origins[(a_frame * a_queries + query) % origins.size()], lockDistance, [&](TargetCandidate&) { ++found; });
+		}
+		Test::DoNotOptimize(found);
+	};
+	const auto measureFrame = [&](const std::vector<RE::NiPoint3>& a_positions, std::size_t a_gridThreshold, std::uint32_t a_queries) {
+		TargetCandidateIndex index;
+		const auto iterations = std::max(20u, 200000u / static_cast<std::uint32_t>(a_positions.size()));
+		return Test::Measure(iterations, [&](std::uint32_t a_i) { runFrame(index, a_positions, a_gridThreshold, a_queries, a_i); });
+	};
+
+	constexpr auto linearScan = std::numeric_limits<std::size_t>::max();
+	std::uint32_t crossover = 0;
+	for (const std::uint32_t count : { 10u, 20u, 50u, 100u, 200u, 500u, 1000u, 2000u, 5000u }) {
+		const auto positions = GetRandomPositions(count, 3);
+		const double linear = measureFrame(positions, linearScan, queriesPerFrame);
+		const double grid = measureFrame(positions, 0, queriesPerFrame);
+		if (grid < linear && crossover == 0) {
+			crossover = count;
+		}
+
+		std::printf(" %u candidates, %u queries, per frame\n", count, queriesPerFrame);
+		Test::Report("linear scan", linear);
+		Test::Report("grid", grid);
+	}
+
+	if (crossover != 0) {
+		std::printf(" the grid is faster from %u candidates, gridThreshold is %zu\n", crossover, TargetCandidateIndex::gridThreshold);
+	} else {
+		std::printf(" the grid is not faster up to 5000 candidates, gridThreshold is %zu\n", TargetCandidateIndex::gridThreshold);
+	}
+
+	// both sides grow linearly with the candidates, what decides is how many queries share one build
+	const auto positions = GetRandomPositions(1000, 3);
+	for (const std::uint32_t queries : { 3u, 10u, 30u }) {
+		std::printf(" 1000 candidates, %u queries, per frame\n", queries);
+		Test::Report("linear scan", measureFrame(positions, linearScan, queries));
+		Test::Report("grid", measureFrame(positions, 0, queries));
+	}
+}
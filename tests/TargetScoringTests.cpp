@@ -0,0 +1,165 @@
+#include "TargetScoring.h"
+#include "Test.h"
+
+namespace
+{
+	using Mode = TargetScoringBatch::Mode;
+
+	struct Candidate
+	{
+		RE::NiPoint3 position;
+		float maxDistance;
+		bool bHostile;
+	};
+
+	const RE::NiPoint3 origin{ 100.f, -200.f, 50.f };
+	const RE::NiPoint3 forward{ 0.6f, 0.8f, 0.f };
+	const TargetScoringBatch::Weights weights{ 1.f, 2.f, 0.5f };
+
+	std::vector<Candidate> GetRandomCandidates(std::uint32_t a_count, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> coordinate(-3000.f, 3000.f);
+		std::uniform_real_distribution<float> maxDistance(1500.f, 2500.f);
+
+		std::vector<Candidate> candidates(a_count);
+		for (auto& candidate : candidates) {
+			candidate.position = origin + RE::NiPoint3{ coordinate(random), coordinate(random), coordinate(random) * 0.1f };
+			candidate.maxDistance = maxDistance(random);
+			candidate.bHostile = (random() & 1) != 0;
+		}
+		return candidates;
+	}
+
+	// the per-candidate scoring FindTarget did before the batch, FLT_MAX when out of range
+	float GetScalarScore(const Candidate& a_candidate, Mode a_mode)
+	{
+		RE::NiPoint3 direction = a_candidate.position - origin;
+		const float distance = direction.Unitize();
+		if (distance > a_candidate.maxDistance) {
+			return FLT_MAX;
+		}
+
+		const float dot = forward.Dot(direction);
+		switch (a_mode) {
+		case Mode::kClosest:
+		default:
+			return distance;
+		case Mode::kCenter:
+			return -dot;
+		case Mode::kCombined:
+			return distance * (1.f - dot);
+		case Mode::kWeighted:
+			return distance / a_candidate.maxDistance * weights.distance + (1.f - dot) * 0.5f * weights.angle + (a_candidate.bHostile ? 0.f : 1.f) * weights.hostility;
+		}
+	}
+
+	void Fill(TargetScoringBatch& a_batch, const std::vector<Candidate>& a_candidates)
+	{
+		a_batch.Clear();
+		for (std::uint32_t i = 0; i < a_candidates.size(); ++i) {
+			a_batch.Add(a_candidates[i].position, a_candidates[i].maxDistance, a_candidates[i].bHostile, i);
+		}
+	}
+}
+
+TEST_CASE(TargetScoringMatchesScalar)
+{
+	// odd count, so the last group of four is padded
+	const auto candidates = GetRandomCandidates(203, 1);
+
+	TargetScoringBatch batch;
+	std::vector<std::uint32_t> ranking;
+	for (const auto mode : { Mode::kClosest, Mode::kCenter, Mode::kCombined, Mode::kWeighted }) {
+		Fill(batch, candidates);
+		batch.Score(origin, forward, mode, weights);
+		CHECK(batch.GetSize() == candidates.size());
+
+		std::uint32_t inRange = 0;
+		std::uint32_t best = 0;
+		float bestScore = FLT_MAX;
+		for (std::uint32_t i = 0; i < candidates.size(); ++i) {
+			const float expected = GetScalarScore(candidates[i], mode);
+			if (expected == FLT_MAX) {
+				CHECK(batch.GetScore(i) == FLT_MAX);
+				continue;
+			}
+
+			// the batch divides the projection by the distance instead of normalizing first, kCombined scales that rounding by the distance
+			const float scale = std::max({ 1.f, std::fabs(expected), candidates[i].position.GetDistance(origin) });
+			CHECK_NEAR(batch.GetScore(i), expected, 1e-5f * scale);
+			++inRange;
+			if (expected < bestScore) {
+				bestScore = expected;
+				best = i;
+			}
+		}
+
+		batch.GetRanking(ranking);
+		CHECK(ranking.size() == inRange);
+		CHECK(!ranking.empty() && ranking.front() == best);
+		CHECK(std::is_sorted(ranking.begin(), ranking.end(), [&](std::uint32_t a_lhs, std::uint32_t a_rhs) { return batch.GetScore(a_lhs) < batch.GetScore(a_rhs); }));
+	}
+}
+
+TEST_CASE(TargetScoringBreaksTiesOnHandle)
+{
+	// equal scores are ranked by handle, whatever order they were added in
+	constexpr std::array<std::uint32_t, 6> handles{ 0x4005, 0x1002, 0x3007, 0x1001, 0x5000, 0x2003 };
+	TargetScoringBatch batch;
+	for (const auto handle : handles) {
+		batch.Add(origin + RE::NiPoint3{ 0.f, 500.f, 0.f }, 1000.f, false, handle);
+	}
+	batch.Add(origin + RE::NiPoint3{ 0.f, 5000.f, 0.f }, 1000.f, false, 0x1000);  // out of range
+	batch.Score(origin, forward, Mode::kClosest, weights);
+
+	std::vector<std::uint32_t> ranking;
+	batch.GetRanking(ranking);
+	CHECK((ranking == std::vector<std::uint32_t>{ 3, 1, 5, 2, 0, 4 }));
+
+	// adding after a score drops the padding again
+	batch.Add(origin + RE::NiPoint3{ 0.f, 100.f, 0.f }, 1000.f, false, 0x6000);
+	batch.Score(origin, forward, Mode::kClosest, weights);
+	batch.GetRanking(ranking);
+	CHECK(ranking.size() == 7 && ranking.front() == 7);
+}
+
+BENCHMARK(TargetScoringSelect)
+{
+	for (const std::uint32_t count : { 16u, 64u, 256u }) {
+		const auto candidates = GetRandomCandidates(count, 2);
+
+		const double scalar = Test::Measure(20000, [&](std::uint32_t) {
+			std::uint32_t best = 0;
+			float bestScore = FLT_MAX;
+			for (std::uint32_t i = 0; i < count; ++i) {
+				const float score = GetScalarScore(candidates[i], Mode::kCombined);
+				if (score < bestScore) {
+					bestScore = score;
+					best = i;
+				}
+			}
+			Test::DoNotOptimize(best);
+		});
+
+		TargetScoringBatch batch;
+		Fill(batch, candidates);
+		const double scoreOnly = Test::Measure(20000, [&](std::uint32_t) {
+			batch.Score(origin, forward, Mode::kCombined, weights);
+			Test::DoNotOptimize(batch.GetScore(0));
+		});
+
+		std::vector<std::uint32_t> ranking;
+		const double batched = Test::Measure(20000, [&](std::uint32_t) {
+			Fill(batch, candidates);
+			batch.Score(origin, forward, Mode::kCombined, weights);
+			batch.GetRanking(ranking);
+			Test::DoNotOptimize(ranking.front());
+		});
+
+		std::printf(" %u candidates\n", count);
+		Test::Report("scalar scoring loop", scalar);
+		Test::Report("batch score", scoreOnly);
+		Test::Report("batch fill, score and rank", batched);
+	}
+}
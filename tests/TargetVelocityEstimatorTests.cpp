@@ -0,0 +1,102 @@
+#include "TargetVelocityEstimator.h"
+#include "Test.h"
+
+namespace
+{
+	constexpr float deltaTime = 1.f / 60.f;
+	constexpr float alpha = 0.5f;
+	constexpr float beta = 0.1f;
+
+	const RE::NiPoint3 targetVelocity{ 300.f, -150.f, 0.f };
+
+	// a_frames frames of a target moving at targetVelocity from a_start, with the character controller velocity off by a_seedError
+	RE::NiPoint3 Track(TargetVelocityEstimator& a_estimator, RE::ActorHandle a_handle, RE::NiPoint3 a_start, std::uint32_t a_firstFrame, std::uint32_t a_frames, const RE::NiPoint3& a_seedError = {})
+	{
+		for (std::uint32_t frame = a_firstFrame; frame < a_firstFrame + a_frames; ++frame) {
+			a_estimator.Update(a_handle, a_start, targetVelocity + a_seedError, frame, deltaTime, alpha, beta);
+			a_start += targetVelocity * deltaTime;
+		}
+		return a_start;
+	}
+
+	float GetError(const TargetVelocityEstimator& a_estimator, RE::ActorHandle a_handle)
+	{
+		RE::NiPoint3 velocity;
+		return a_estimator.GetVelocity(a_handle, velocity) ? (velocity - targetVelocity).Length() : std::numeric_limits<float>::max();
+	}
+}
+
+TEST_CASE(TargetVelocityEstimatorConverges)
+{
+	const auto handle = Test::MakeHandle<RE::Actor>(1);
+	TargetVelocityEstimator estimator;
+
+	// the seed is off, the positions pull it in
+	Track(estimator, handle, { 0.f, 0.f, 0.f }, 1, 300, { 200.f, 200.f, 0.f });
+	CHECK(GetError(estimator, handle) <= 1.f);
+}
+
+TEST_CASE(TargetVelocityEstimatorWarmsUp)
+{
+	const auto handle = Test::MakeHandle<RE::Actor>(1);
+	TargetVelocityEstimator estimator;
+	RE::NiPoint3 velocity;
+
+	Track(estimator, handle, { 0.f, 0.f, 0.f }, 1, 2);
+	CHECK(!estimator.GetVelocity(handle, velocity));
+	Track(estimator, handle, targetVelocity * (2.f * deltaTime), 3, 1);
+	CHECK(estimator.GetVelocity(handle, velocity));
+
+	// only for the actor it was tracking
+	CHECK(!estimator.GetVelocity(Test::MakeHandle<RE::Actor>(2), velocity));
+	CHECK(!estimator.GetVelocity(RE::ActorHandle(), velocity));
+
+	estimator.Reset();
+	CHECK(!estimator.GetVelocity(handle, velocity));
+}
+
+TEST_CASE(TargetVelocityEstimatorReseedsAfterGap)
+{
+	const auto handle = Test::MakeHandle<RE::Actor>(1);
+	TargetVelocityEstimator estimator;
+	RE::NiPoint3 velocity;
+
+	// locked, then unlocked for two seconds while the target kept walking, then locked again. The gap is short enough not to look like a teleport.
+	const auto end = Track(estimator, handle, { 0.f, 0.f, 0.f }, 1, 60);
+	Track(estimator, handle, end + targetVelocity * 2.f, 181, 3);
+	CHECK(GetError(estimator, handle) <= 1.f);
+
+	// switching to another actor and straight back starts over too
+	const auto other = Test::MakeHandle<RE::Actor>(2);
+	estimator.Update(other, { 5000.f, 5000.f, 0.f }, {}, 184, deltaTime, alpha, beta);
+	CHECK(!estimator.GetVelocity(handle, velocity));
+	Track(estimator, handle, end + targetVelocity * 2.1f, 185, 3);
+	CHECK(GetError(estimator, handle) <= 1.f);
+
+	// a reset with no gap, the same as SetTarget clearing and relocking within a frame
+	estimator.Reset();
+	Track(estimator, handle, { -2000.f, 0.f, 0.f }, 188, 3);
+	CHECK(GetError(estimator, handle) <= 1.f);
+}
+
+TEST_CASE(TargetVelocityEstimatorReseedsOnTeleport)
+{
+	const auto handle = Test::MakeHandle<RE::Actor>(1);
+	TargetVelocityEstimator estimator;
+
+	Track(estimator, handle, { 0.f, 0.f, 0.f }, 1, 60);
+	Track(estimator, handle, { 10000.f, 0.f, 0.f }, 61, 3);
+	CHECK(GetError(estimator, handle) <= 1.f);
+}
+
+BENCHMARK(TargetVelocityEstimatorUpdate)
+{
+	const auto handle = Test::MakeHandle<RE::Actor>(1);
+	TargetVelocityEstimator estimator;
+	RE::NiPoint3 velocity;
+
+	Test::Report("Update and GetVelocity, per frame", Test::Measure(100000, [&](std::uint32_t a_i) {
+		estimator.Update(handle, targetVelocity * (static_cast<float>(a_i) * deltaTime), targetVelocity, a_i + 1, deltaTime, alpha, beta);
+		Test::DoNotOptimize(estimator.GetVelocity(handle, velocity));
+	}));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Minimal test and benchmark registry for the headless target. Tests fail through CHECK and are run by ctest, benchmarks only print
+// their timings and are run with --benchmark.
+namespace Test
+{
+	using Func = void (*)();
+
+	struct Case
+	{
+		std::string_view name;
+		Func func;
+		bool bBenchmark;
+	};
+
+	std::vector<Case>& GetCases();
+	void Fail(const char* a_expression, const char* a_file, int a_line);
+	void Report(std::string_view a_name, double a_nanosecondsPerOp);
+
+	struct Registrar
+	{
+		Registrar(std::string_view a_name, Func a_func, bool a_bBenchmark) { GetCases().push_back({ a_name, a_func, a_bBenchmark }); }
+	};
+
+	inline volatile std::uint8_t doNotOptimizeSink = 0;
+
+	// keeps the optimizer from dropping a result that is otherwise unused
+	template <class T>
+	void DoNotOptimize(const T& a_value)
+	{
+		doNotOptimizeSink = *reinterpret_cast<const volatile std::uint8_t*>(&a_value);
+	}
+
+	// a handle with the given native value, for tests that only compare handles and never resolve them
+	template <class T = RE::TESObjectREFR>
+	RE::BSPointerHandle<T> MakeHandle(std::uint32_t a_nativeHandle)
+	{
+		RE::BSPointerHandle<T> handle;
+		static_assert(sizeof(handle) == sizeof(a_nativeHandle));
+		std::memcpy(static_cast<void*>(std::addressof(handle)), std::addressof(a_nativeHandle), sizeof(a_nativeHandle));
+		return handle;
+	}
+
+	// best of a few runs of a_iterations calls, in nanoseconds per call
+	template <class F>
+	double Measure(std::uint32_t a_iterations, F&& a_func)
+	{
+		constexpr std::uint32_t runs = 5;
+
+		double best = std::numeric_limits<double>::max();
+		for (std::uint32_t run = 0; run < runs; ++run) {
+			const auto start = std::chrono::steady_clock::now();
+			for (std::uint32_t i = 0; i < a_iterations; ++i) {
+				a_func(i);
+			}
+			const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count() / a_iterations);
+		}
+		return best;
+	}
+}
+
+#define TDM_TEST_REGISTER(a_name, a_bBenchmark)                                \
+	static void a_name();                                                         \
+	static const Test::Registrar a_name##Registrar{ #a_name, a_name, a_bBenchmark }; \
+	static void a_name()
+
+#define TEST_CASE(a_name) TDM_TEST_REGISTER(a_name, false)
+#define BENCHMARK(a_name) TDM_TEST_REGISTER(a_name, true)
+
+#define CHECK(a_expression) ((a_expression) ? static_cast<void>(0) : Test::Fail(#a_expression, __FILE__, __LINE__))
+#define CHECK_NEAR(a_value, a_expected, a_tolerance) CHECK(std::fabs(static_cast<double>(a_value) - static_cast<double>(a_expected)) <= static_cast<double>(a_tolerance))
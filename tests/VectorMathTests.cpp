@@ -0,0 +1,195 @@
+#include "MathUtils.h"
+#include "Test.h"
+#include "VectorMath.h"
+
+namespace
+{
+	std::vector<RE::NiPoint3> GetRandomPoints(std::uint32_t a_count, float a_extent, std::uint32_t a_seed)
+	{
+		std::mt19937 random(a_seed);
+		std::uniform_real_distribution<float> coordinate(-a_extent, a_extent);
+
+		std::vector<RE::NiPoint3> points(a_count);
+		for (auto& point : points) {
+			point = { coordinate(random), coordinate(random), coordinate(random) };
+		}
+		return points;
+	}
+
+	RE::NiQuaternion GetRandomQuaternion(std::mt19937& a_random)
+	{
+		std::normal_distribution<float> component;
+		RE::NiQuaternion quat{ component(a_random), component(a_random), component(a_random), component(a_random) };
+		const float length = std::sqrt(quat.w * quat.w + quat.x * quat.x + quat.y * quat.y + quat.z * quat.z);
+		return { quat.w / length, quat.x / length, quat.y / length, quat.z / length };
+	}
+
+	// largest component difference, relative to a_scale
+	float GetError(const RE::NiPoint3& a_point, const RE::NiPoint3& a_expected, float a_scale)
+	{
+		return std::max({ std::fabs(a_point.x - a_expected.x), std::fabs(a_point.y - a_expected.y), std::fabs(a_point.z - a_expected.z) }) / std::max(a_scale, 1.f);
+	}
+
+	// the engine's NiCamera::WorldPtToScreenPt3, which can only be called in game
+	bool WorldPtToScreenPt3(const float (&a_matrix)[4][4], const RE::NiRect<float>& a_viewPort, const RE::NiPoint3& a_point, RE::NiPoint2& a_outScreenPoint, float& a_outDepth)
+	{
+		const auto transform = [&](std::size_t a_row) {
+			return a_matrix[a_row][0] * a_point.x + a_matrix[a_row][1] * a_point.y + a_matrix[a_row][2] * a_point.z + a_matrix[a_row][3];
+		};
+
+		const float w = transform(3);
+		if (w <= 1e-5f) {
+			return false;
+		}
+
+		const float inverseW = 1.f / w;
+		a_outScreenPoint.x = (transform(0) * inverseW + 1.f) * 0.5f * (a_viewPort.right - a_viewPort.left) + a_viewPort.left;
+		a_outScreenPoint.y = (transform(1) * inverseW + 1.f) * 0.5f * (a_viewPort.top - a_viewPort.bottom) + a_viewPort.bottom;
+		a_outDepth = transform(2) * inverseW;
+		return true;
+	}
+
+	// a perspective projection looking down +y from the origin
+	constexpr float worldToCamMatrix[4][4] = {
+		{ 1.2f, 0.f, 0.f, 0.f },
+		{ 0.f, 0.f, 1.6f, 0.f },
+		{ 0.f, 1.001f, 0.f, -10.f },
+		{ 0.f, 1.f, 0.f, 0.f },
+	};
+	const RE::NiRect<float> viewPort{ 0.f, 1.f, 1.f, 0.f };
+}
+
+TEST_CASE(VectorMathMatchesNiPoint3)
+{
+	const auto points = GetRandomPoints(10000, 5000.f, 1);
+	std::mt19937 random(2);
+
+	float maxError = 0.f;
+	for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+		const auto& a = points[i];
+		const auto& b = points[i + 1];
+		const auto vectorA = VectorMath::Load(a);
+		const auto vectorB = VectorMath::Load(b);
+		const float scale = a.Length() * b.Length();
+
+		maxError = std::max(maxError, std::fabs(VectorMath::Dot(vectorA, vectorB) - a.Dot(b)) / std::max(scale, 1.f));
+		maxError = std::max(maxError, GetError(VectorMath::ToNiPoint3(VectorMath::Cross(vectorA, vectorB)), a.Cross(b), scale));
+		maxError = std::max(maxError, GetError(VectorMath::ToNiPoint3(VectorMath::Project(vectorA, vectorB)), Project(a, b), a.Length()));
+
+		const auto quat = GetRandomQuaternion(random);
+		maxError = std::max(maxError, GetError(VectorMath::ToNiPoint3(VectorMath::Rotate(vectorA, quat)), RotateVector(a, quat), a.Length()));
+		maxError = std::max(maxError, GetError(VectorMath::ToNiPoint3(VectorMath::ClampLength(vectorA, 2000.f)), ClampSizeMax(a, 2000.f), a.Length()));
+	}
+	CHECK(maxError <= 1e-6f);
+}
+
+TEST_CASE(VectorMathNormalize)
+{
+	auto points = GetRandomPoints(10000, 5000.f, 3);
+	for (const float length : { 1e-3f, 1e-10f, 0.f }) {
+		points.push_back({ length, -length, length });
+	}
+
+	float maxError = 0.f;
+	float maxLengthError = 0.f;
+	bool bSameZero = true;
+	for (const auto& point : points) {
+		RE::NiPoint3 expected = point;
+		const float expectedLength = expected.Unitize();
+
+		float length = 0.f;
+		const auto normalized = VectorMath::ToNiPoint3(VectorMath::Normalize(VectorMath::Load(point), &length));
+		if (expectedLength == 0.f) {
+			bSameZero &= normalized == RE::NiPoint3{} && length == 0.f;
+			continue;
+		}
+
+		maxError = std::max(maxError, GetError(normalized, expected, 0.f));
+		maxLengthError = std::max(maxLengthError, std::fabs(length - expectedLength) / expectedLength);
+	}
+	CHECK(maxError <= 1e-6f);
+	CHECK(maxLengthError <= 1e-6f);
+	CHECK(bSameZero);
+}
+
+TEST_CASE(VectorMathLoadStoreStayInBounds)
+{
+	// loads and stores of a NiPoint3 touch exactly its 12 bytes, so neighbours and the end of an array are safe
+	std::array<RE::NiPoint3, 3> points{ RE::NiPoint3{ 1.f, 2.f, 3.f }, RE::NiPoint3{ 4.f, 5.f, 6.f }, RE::NiPoint3{ 7.f, 8.f, 9.f } };
+	VectorMath::Store(VectorMath::Set(-1.f, -2.f, -3.f), points[1]);
+	CHECK(points[0] == RE::NiPoint3(1.f, 2.f, 3.f));
+	CHECK(points[1] == RE::NiPoint3(-1.f, -2.f, -3.f));
+	CHECK(points[2] == RE::NiPoint3(7.f, 8.f, 9.f));
+
+	const auto last = VectorMath::Load(points[2]);
+	CHECK(VectorMath::GetX(last) == 7.f && VectorMath::GetY(last) == 8.f && VectorMath::GetZ(last) == 9.f);
+	CHECK(VectorMath::ToNiPoint3(VectorMath::FlattenZ(last)) == RE::NiPoint3(7.f, 8.f, 0.f));
+}
+
+TEST_CASE(VectorMathWorldPtsToScreenPts3MatchesScalar)
+{
+	// some of them behind the camera
+	const auto points = GetRandomPoints(1003, 5000.f, 4);
+
+	bool bSame = true;
+	float maxError = 0.f;
+	for (const std::size_t size : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 3 }, std::size_t{ 4 }, std::size_t{ 5 }, points.size() }) {
+		std::vector<RE::NiPoint2> screenPoints(size);
+		std::vector<float> depths(size);
+		VectorMath::WorldPtsToScreenPts3(worldToCamMatrix, viewPort, std::span{ points.data(), size }, screenPoints, depths);
+
+		for (std::size_t i = 0; i < size; ++i) {
+			RE::NiPoint2 expectedScreenPoint;
+			float expectedDepth = 0.f;
+			if (!WorldPtToScreenPt3(worldToCamMatrix, viewPort, points[i], expectedScreenPoint, expectedDepth)) {
+				bSame &= depths[i] == -1.f && screenPoints[i].x == 0.f && screenPoints[i].y == 0.f;
+				continue;
+			}
+
+			maxError = std::max({ maxError, std::fabs(screenPoints[i].x - expectedScreenPoint.x), std::fabs(screenPoints[i].y - expectedScreenPoint.y), std::fabs(depths[i] - expectedDepth) });
+		}
+	}
+	CHECK(bSame);
+	CHECK(maxError <= 1e-5f);
+}
+
+BENCHMARK(VectorMathKernels)
+{
+	const auto points = GetRandomPoints(4096, 5000.f, 5);
+	const auto count = static_cast<std::uint32_t>(points.size());
+	std::mt19937 random(6);
+	const auto quat = GetRandomQuaternion(random);
+
+	Test::Report("NiPoint3::Unitize", Test::Measure(count, [&](std::uint32_t a_i) {
+		RE::NiPoint3 point = points[a_i];
+		Test::DoNotOptimize(point.Unitize());
+		Test::DoNotOptimize(point);
+	}));
+
+	Test::Report("VectorMath::Normalize", Test::Measure(count, [&](std::uint32_t a_i) {
+		float length;
+		Test::DoNotOptimize(VectorMath::ToNiPoint3(VectorMath::Normalize(VectorMath::Load(points[a_i]), &length)));
+		Test::DoNotOptimize(length);
+	}));
+
+	Test::Report("RotateVector", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(RotateVector(points[a_i], quat));
+	}));
+
+	Test::Report("VectorMath::Rotate", Test::Measure(count, [&](std::uint32_t a_i) {
+		Test::DoNotOptimize(VectorMath::ToNiPoint3(VectorMath::Rotate(VectorMath::Load(points[a_i]), quat)));
+	}));
+
+	std::vector<RE::NiPoint2> screenPoints(points.size());
+	std::vector<float> depths(points.size());
+
+	Test::Report("WorldPtToScreenPt3, per point", Test::Measure(count, [&](std::uint32_t a_i) {
+		WorldPtToScreenPt3(worldToCamMatrix, viewPort, points[a_i], screenPoints[a_i], depths[a_i]);
+		Test::DoNotOptimize(depths[a_i]);
+	}));
+
+	Test::Report("WorldPtsToScreenPts3, per point", Test::Measure(100, [&](std::uint32_t) {
+		VectorMath::WorldPtsToScreenPts3(worldToCamMatrix, viewPort, points, screenPoints, depths);
+		Test::DoNotOptimize(depths.back());
+	}) / count);
+}
@@ -0,0 +1,55 @@
+#include "Test.h"
+
+namespace Test
+{
+	namespace
+	{
+		std::uint32_t failures = 0;
+	}
+
+	std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void Fail(const char* a_expression, const char* a_file, int a_line)
+	{
+		++failures;
+		std::printf("%s(%d): CHECK(%s) failed\n", a_file, a_line, a_expression);
+	}
+
+	void Report(std::string_view a_name, double a_nanosecondsPerOp)
+	{
+		std::printf("  %-48.*s %10.2f ns\n", static_cast<int>(a_name.size()), a_name.data(), a_nanosecondsPerOp);
+	}
+}
+
+// TrueDirectionalMovementTests [--benchmark] [name filter]
+int main(int a_argc, char* a_argv[])
+{
+	bool bBenchmark = false;
+	std::string_view filter;
+	for (int i = 1; i < a_argc; ++i) {
+		const std::string_view arg = a_argv[i];
+		if (arg == "--benchmark"sv) {
+			bBenchmark = true;
+		} else {
+			filter = arg;
+		}
+	}
+
+	std::uint32_t run = 0;
+	for (const auto& testCase : Test::GetCases()) {
+		if (testCase.bBenchmark != bBenchmark || testCase.name.find(filter) == std::string_view::npos) {
+			continue;
+		}
+
+		std::printf("%.*s\n", static_cast<int>(testCase.name.size()), testCase.name.data());
+		testCase.func();
+		++run;
+	}
+
+	std::printf("%u %s run, %u failed checks\n", run, bBenchmark ? "benchmarks" : "tests", Test::failures);
+	return Test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,529 @@
+#pragma once
+
+// Stand-ins for the few CommonLibSSE types the game independent modules use, so the tests build without the game or CommonLib.
+// Only the members those modules touch are declared, with the same layout and semantics as in CommonLib.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#if defined(__GLIBCXX__)
+// libstdc++ only declares the float overloads of <cmath> in the global namespace
+namespace std
+{
+	inline float sqrtf(float a_value) { return ::sqrtf(a_value); }
+}
+#endif
+
+#if !defined(_MSC_VER)
+#	include <strings.h>
+
+inline int _stricmp(const char* a_lhs, const char* a_rhs) { return ::strcasecmp(a_lhs, a_rhs); }
+#endif
+
+namespace RE
+{
+	class NiPoint2
+	{
+	public:
+		constexpr NiPoint2() noexcept = default;
+		constexpr NiPoint2(float a_x, float a_y) noexcept :
+			x(a_x),
+			y(a_y)
+		{}
+
+		NiPoint2 operator+(const NiPoint2& a_rhs) const { return { x + a_rhs.x, y + a_rhs.y }; }
+		NiPoint2 operator-(const NiPoint2& a_rhs) const { return { x - a_rhs.x, y - a_rhs.y }; }
+		NiPoint2 operator*(float a_scalar) const { return { x * a_scalar, y * a_scalar }; }
+		NiPoint2 operator/(float a_scalar) const { return operator*(1.0F / a_scalar); }
+
+		[[nodiscard]] float Cross(const NiPoint2& a_pt) const { return x * a_pt.y - y * a_pt.x; }
+		[[nodiscard]] float Dot(const NiPoint2& a_pt) const { return x * a_pt.x + y * a_pt.y; }
+		[[nodiscard]] float Length() const { return std::sqrt(SqrLength()); }
+		[[nodiscard]] float SqrLength() const { return x * x + y * y; }
+
+		float Unitize()
+		{
+			auto length = Length();
+			if (length == 1.f) {
+				return length;
+			} else if (length > FLT_EPSILON) {
+				*this = *this / length;
+			} else {
+				x = 0.0;
+				y = 0.0;
+				length = 0.0;
+			}
+			return length;
+		}
+
+		// members
+		float x{ 0.0F };  // 0
+		float y{ 0.0F };  // 4
+	};
+	static_assert(sizeof(NiPoint2) == 0x8);
+
+	class NiPoint3
+	{
+	public:
+		constexpr NiPoint3() noexcept = default;
+		constexpr NiPoint3(float a_x, float a_y, float a_z) noexcept :
+			x(a_x),
+			y(a_y),
+			z(a_z)
+		{}
+
+		bool operator==(const NiPoint3& a_rhs) const { return x == a_rhs.x && y == a_rhs.y && z == a_rhs.z; }
+		bool operator!=(const NiPoint3& a_rhs) const { return !operator==(a_rhs); }
+
+		NiPoint3 operator+(const NiPoint3& a_rhs) const { return { x + a_rhs.x, y + a_rhs.y, z + a_rhs.z }; }
+		NiPoint3 operator-(const NiPoint3& a_rhs) const { return { x - a_rhs.x, y - a_rhs.y, z - a_rhs.z }; }
+		NiPoint3 operator*(float a_scalar) const { return { x * a_scalar, y * a_scalar, z * a_scalar }; }
+		NiPoint3 operator/(float a_scalar) const { return operator*(1.0F / a_scalar); }
+		NiPoint3 operator-() const { return { -x, -y, -z }; }
+
+		NiPoint3& operator+=(const NiPoint3& a_rhs) { return *this = *this + a_rhs; }
+		NiPoint3& operator-=(const NiPoint3& a_rhs) { return *this = *this - a_rhs; }
+		NiPoint3& operator*=(float a_scalar) { return *this = *this * a_scalar; }
+		NiPoint3& operator/=(float a_scalar) { return *this = *this / a_scalar; }
+
+		[[nodiscard]] NiPoint3 Cross(const NiPoint3& a_pt) const { return { y * a_pt.z - z * a_pt.y, z * a_pt.x - x * a_pt.z, x * a_pt.y - y * a_pt.x }; }
+		[[nodiscard]] float Dot(const NiPoint3& a_pt) const { return x * a_pt.x + y * a_pt.y + z * a_pt.z; }
+		[[nodiscard]] float GetDistance(const NiPoint3& a_pt) const { return (*this - a_pt).Length(); }
+		[[nodiscard]] float Length() const { return std::sqrt(SqrLength()); }
+		[[nodiscard]] float SqrLength() const { return x * x + y * y + z * z; }
+
+		float Unitize()
+		{
+			auto length = Length();
+			if (length == 1.f) {
+				return length;
+			} else if (length > FLT_EPSILON) {
+				operator/=(length);
+			} else {
+				x = 0.0;
+				y = 0.0;
+				z = 0.0;
+				length = 0.0;
+			}
+			return length;
+		}
+
+		// members
+		float x{ 0.0F };  // 0
+		float y{ 0.0F };  // 4
+		float z{ 0.0F };  // 8
+	};
+	static_assert(sizeof(NiPoint3) == 0xC);
+
+	class NiMatrix3
+	{
+	public:
+		// members
+		float entry[3][3]{};  // 00
+	};
+	static_assert(sizeof(NiMatrix3) == 0x24);
+
+	class NiQuaternion
+	{
+	public:
+		// members
+		float w{ 0.0F };  // 0
+		float x{ 0.0F };  // 4
+		float y{ 0.0F };  // 8
+		float z{ 0.0F };  // C
+	};
+	static_assert(sizeof(NiQuaternion) == 0x10);
+
+	template <class T>
+	class NiRect
+	{
+	public:
+		// members
+		T left{};    // 00
+		T right{};   // ??
+		T top{};     // ??
+		T bottom{};  // ??
+	};
+
+	class hkVector4
+	{
+	public:
+		// members
+		__m128 quad{};  // 00
+	};
+	static_assert(sizeof(hkVector4) == 0x10);
+
+	class NiTransform
+	{
+	public:
+		// members
+		NiMatrix3 rotate;         // 00
+		NiPoint3 translate;       // 24
+		float scale{ 1.0F };      // 30
+	};
+	static_assert(sizeof(NiTransform) == 0x34);
+
+	// the scene graph node, only its transforms
+	class NiAVObject
+	{
+	public:
+		// members
+		NiTransform local;
+		NiTransform world;
+	};
+
+	// CommonLib's NiPointer adds a reference, the tests own their objects so a plain pointer does
+	template <class T>
+	class NiPointer
+	{
+	public:
+		constexpr NiPointer() noexcept = default;
+		constexpr NiPointer(T* a_rhs) noexcept :
+			_ptr(a_rhs)
+		{}
+
+		constexpr void reset(T* a_ptr = nullptr) noexcept { _ptr = a_ptr; }
+
+		[[nodiscard]] constexpr T* get() const noexcept { return _ptr; }
+		[[nodiscard]] constexpr T* operator->() const noexcept { return get(); }
+		[[nodiscard]] constexpr T& operator*() const noexcept { return *get(); }
+		[[nodiscard]] explicit constexpr operator bool() const noexcept { return _ptr != nullptr; }
+
+		[[nodiscard]] constexpr bool operator==(const NiPointer& a_rhs) const noexcept { return _ptr == a_rhs._ptr; }
+
+	private:
+		T* _ptr{ nullptr };
+	};
+
+	namespace detail
+	{
+		// the game's table of live references, the test objects that can be looked up by handle add themselves to it
+		struct HandleTable
+		{
+			std::unordered_map<std::uint32_t, void*> objects;
+			std::unordered_map<const void*, std::uint32_t> handles;
+		};
+
+		inline HandleTable& GetHandleTable()
+		{
+			static HandleTable table;
+			return table;
+		}
+	}
+
+	template <class T>
+	class BSPointerHandle
+	{
+	public:
+		using native_handle_type = std::uint32_t;
+
+		constexpr BSPointerHandle() noexcept = default;
+
+		explicit BSPointerHandle(T* a_rhs)
+		{
+			const auto& handles = detail::GetHandleTable().handles;
+			if (const auto it = handles.find(a_rhs); it != handles.end()) {
+				_handle = it->second;
+			}
+		}
+
+		[[nodiscard]] NiPointer<T> get() const
+		{
+			const auto& objects = detail::GetHandleTable().objects;
+			const auto it = objects.find(_handle);
+			return it != objects.end() ? static_cast<T*>(it->second) : nullptr;
+		}
+
+		[[nodiscard]] constexpr native_handle_type native_handle() const noexcept { return _handle; }
+		[[nodiscard]] explicit constexpr operator bool() const noexcept { return _handle != 0; }
+
+		[[nodiscard]] constexpr bool operator==(const BSPointerHandle& a_rhs) const noexcept { return _handle == a_rhs._handle; }
+
+	private:
+		native_handle_type _handle{ 0 };
+	};
+	static_assert(sizeof(BSPointerHandle<void>) == 0x4);
+
+	// Unlike CommonLib's, interned case sensitively, which is all the tests need
+	class BSFixedString
+	{
+	public:
+		BSFixedString(const char* a_string) :
+			_data(Intern(a_string))
+		{}
+
+		[[nodiscard]] const char* c_str() const noexcept { return _data; }
+
+		[[nodiscard]] bool operator==(const BSFixedString& a_rhs) const noexcept { return _data == a_rhs._data; }
+
+	private:
+		// the game's global string table, taken on every construction
+		static const char* Intern(const char* a_string)
+		{
+			static std::mutex lock;
+			static std::unordered_set<std::string> strings;
+
+			std::lock_guard locker(lock);
+			return strings.emplace(a_string).first->c_str();
+		}
+
+		const char* _data;
+	};
+
+	// CommonLib's BSTArray, hkArray, hkRefPtr and BSTSmartPointer, over standard storage and plain pointers
+	template <class T>
+	class BSTArray
+	{
+	public:
+		[[nodiscard]] T& operator[](std::uint32_t a_pos) { return _data[a_pos]; }
+		[[nodiscard]] const T& operator[](std::uint32_t a_pos) const { return _data[a_pos]; }
+		[[nodiscard]] std::uint32_t size() const noexcept { return static_cast<std::uint32_t>(_data.size()); }
+
+		void push_back(const T& a_value) { _data.push_back(a_value); }
+
+	private:
+		std::vector<T> _data;
+	};
+
+	template <class T>
+	class hkArray
+	{
+	public:
+		[[nodiscard]] T& operator[](std::int32_t a_pos) { return _data[a_pos]; }
+		[[nodiscard]] const T& operator[](std::int32_t a_pos) const { return _data[a_pos]; }
+		[[nodiscard]] T* data() noexcept { return _data.data(); }
+		[[nodiscard]] const T* data() const noexcept { return _data.data(); }
+		[[nodiscard]] std::int32_t size() const noexcept { return static_cast<std::int32_t>(_data.size()); }
+
+		// not in CommonLib, the tests fill the arrays the game would load
+		void push_back(const T& a_value) { _data.push_back(a_value); }
+
+	private:
+		std::vector<T> _data;
+	};
+
+	template <class T>
+	using hkRefPtr = NiPointer<T>;
+
+	template <class T>
+	using BSTSmartPointer = NiPointer<T>;
+
+	class hkStringPtr
+	{
+	public:
+		hkStringPtr(const char* a_string = nullptr) :
+			_data(a_string)
+		{}
+
+		[[nodiscard]] const char* c_str() const noexcept { return _data; }
+
+	private:
+		const char* _data;
+	};
+
+	class hkbVariableValue
+	{
+	public:
+		// members
+		std::int32_t value;  // 0
+	};
+	static_assert(sizeof(hkbVariableValue) == 0x4);
+
+	class hkbVariableValueSet
+	{
+	public:
+		// members
+		hkArray<hkbVariableValue> wordVariableValues;
+	};
+
+	class hkbBehaviorGraphStringData
+	{
+	public:
+		// members
+		hkArray<hkStringPtr> variableNames;
+	};
+
+	class hkbBehaviorGraphData
+	{
+	public:
+		// members
+		hkRefPtr<hkbBehaviorGraphStringData> stringData;
+	};
+
+	class hkbBehaviorGraph
+	{
+	public:
+		// members
+		hkRefPtr<hkbVariableValueSet> variableValueSet;
+		hkRefPtr<hkbBehaviorGraphData> data;
+	};
+
+	class BShkbAnimationGraph
+	{
+	public:
+		struct RUNTIME_DATA
+		{
+			hkbBehaviorGraph* behaviorGraph;
+		};
+
+		[[nodiscard]] RUNTIME_DATA& GetRuntimeData() noexcept { return _runtimeData; }
+		[[nodiscard]] const RUNTIME_DATA& GetRuntimeData() const noexcept { return _runtimeData; }
+
+		// the engine's own name to value index map, what the string keyed accessors go through
+		std::unordered_map<const char*, std::int32_t> variableIndices;
+
+	private:
+		RUNTIME_DATA _runtimeData{};
+	};
+
+	class BSAnimationGraphManager
+	{
+	public:
+		struct RUNTIME_DATA
+		{
+			std::uint32_t activeGraph;
+		};
+
+		[[nodiscard]] RUNTIME_DATA& GetRuntimeData() noexcept { return _runtimeData; }
+		[[nodiscard]] const RUNTIME_DATA& GetRuntimeData() const noexcept { return _runtimeData; }
+
+		// members
+		BSTArray<BSTSmartPointer<BShkbAnimationGraph>> graphs;
+
+	private:
+		RUNTIME_DATA _runtimeData{};
+	};
+
+	class Actor;
+
+	class TESObjectREFR
+	{
+	public:
+		virtual ~TESObjectREFR() = default;
+
+		template <class T>
+		[[nodiscard]] T* As() noexcept
+		{
+			return dynamic_cast<T*>(this);
+		}
+	};
+
+	using ActorHandle = BSPointerHandle<Actor>;
+	using ObjectRefHandle = BSPointerHandle<TESObjectREFR>;
+	using ActorPtr = NiPointer<Actor>;
+
+	// an actor that can be looked up by a_nativeHandle for as long as it lives, with its animation graphs
+	class Actor : public TESObjectREFR
+	{
+	public:
+		explicit Actor(std::uint32_t a_nativeHandle)
+		{
+			auto& table = detail::GetHandleTable();
+			table.objects[a_nativeHandle] = this;
+			table.handles[this] = a_nativeHandle;
+		}
+
+		~Actor() override
+		{
+			auto& table = detail::GetHandleTable();
+			table.objects.erase(table.handles[this]);
+			table.handles.erase(this);
+		}
+
+		Actor(const Actor&) = delete;
+		Actor& operator=(const Actor&) = delete;
+
+		[[nodiscard]] ActorHandle GetHandle() { return ActorHandle(this); }
+
+		bool GetAnimationGraphManager(BSTSmartPointer<BSAnimationGraphManager>& a_out) const
+		{
+			a_out = animationGraphManager;
+			return static_cast<bool>(a_out);
+		}
+
+		// like the engine, a name lookup in the active graph
+		bool GetGraphVariableFloat(const BSFixedString& a_variableName, float& a_out) const
+		{
+			if (!animationGraphManager || animationGraphManager->GetRuntimeData().activeGraph >= animationGraphManager->graphs.size()) {
+				return false;
+			}
+
+			auto& graph = *animationGraphManager->graphs[animationGraphManager->GetRuntimeData().activeGraph];
+			const auto it = graph.variableIndices.find(a_variableName.c_str());
+			if (it == graph.variableIndices.end()) {
+				return false;
+			}
+
+			std::memcpy(&a_out, std::addressof(graph.GetRuntimeData().behaviorGraph->variableValueSet->wordVariableValues[it->second]), sizeof(float));
+			return true;
+		}
+
+		// like the engine, a name lookup in every graph
+		bool SetGraphVariableFloat(const BSFixedString& a_variableName, float a_in) const
+		{
+			bool bSet = false;
+			if (animationGraphManager) {
+				for (std::uint32_t i = 0; i < animationGraphManager->graphs.size(); ++i) {
+					auto& graph = *animationGraphManager->graphs[i];
+					if (const auto it = graph.variableIndices.find(a_variableName.c_str()); it != graph.variableIndices.end()) {
+						std::memcpy(std::addressof(graph.GetRuntimeData().behaviorGraph->variableValueSet->wordVariableValues[it->second]), &a_in, sizeof(float));
+						bSet = true;
+					}
+				}
+			}
+			return bSet;
+		}
+
+		// members
+		BSTSmartPointer<BSAnimationGraphManager> animationGraphManager;
+	};
+
+	// a projectile reference, only its placement and its velocity
+	class Projectile
+	{
+	public:
+		struct OBJ_REFR
+		{
+			NiPoint3 angle;     // 00
+			NiPoint3 location;  // 0C
+		};
+
+		struct PROJECTILE_RUNTIME_DATA
+		{
+			NiPoint3 linearVelocity;
+		};
+
+		[[nodiscard]] PROJECTILE_RUNTIME_DATA& GetProjectileRuntimeData() noexcept { return _runtimeData; }
+		[[nodiscard]] const PROJECTILE_RUNTIME_DATA& GetProjectileRuntimeData() const noexcept { return _runtimeData; }
+
+		// members
+		OBJ_REFR data;
+
+	private:
+		PROJECTILE_RUNTIME_DATA _runtimeData;
+	};
+}